@@ -0,0 +1,188 @@
+/*
+    SPI_Master_Block.cpp - block transfers on the master side of the link
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+*/
+
+#include <Energia.h>
+#include <SPI.h>
+
+#include "SPI_Master_Block.h"
+
+volatile uint8_t *SPIMasterBlockClass::csOut = &SPIMasterBlockClass::portNone;
+uint8_t SPIMasterBlockClass::csMask = 0;
+uint8_t SPIMasterBlockClass::csActiveBits = 0;
+volatile uint8_t *SPIMasterBlockClass::readyIn = &SPIMasterBlockClass::portNone;
+uint8_t SPIMasterBlockClass::readyMask = 0;
+uint8_t SPIMasterBlockClass::readyBits = 0;
+uint16_t SPIMasterBlockClass::readyMs = SPI_MASTER_BLOCK_READY_MS;
+uint8_t SPIMasterBlockClass::portNone = 0;
+uint16_t SPIMasterBlockClass::gapUs = 0;
+uint32_t SPIMasterBlockClass::released = 0;
+bool SPIMasterBlockClass::dma = false;
+bool SPIMasterBlockClass::running = false;
+uint8_t *SPIMasterBlockClass::rxNext = 0;
+const uint8_t *SPIMasterBlockClass::txNext = 0;
+uint16_t SPIMasterBlockClass::left = 0;
+
+/*
+    CS is driven through the cached port register.
+*/
+void SPIMasterBlockClass::select(bool on)
+{
+    if (on == (csActiveBits != 0))
+    {
+        *csOut |= csMask;
+    }
+    else
+    {
+        *csOut &= ~csMask;
+    }
+    if (!on)
+    {
+        released = micros();
+    }
+}
+
+void SPIMasterBlockClass::begin(uint8_t csPin, uint8_t module, uint8_t csActiveLevel)
+{
+    uint8_t port = digitalPinToPort(csPin);
+
+    if (port != NOT_A_PORT)
+    {
+        digitalWrite(csPin, (csActiveLevel == HIGH) ? LOW : HIGH);
+        pinMode(csPin, OUTPUT);
+        csOut = portOutputRegister(port);
+        csMask = digitalPinToBitMask(csPin);
+        csActiveBits = (csActiveLevel == HIGH) ? csMask : 0;
+    }
+    dma = (spi_master_block_begin(module) != 0);
+    running = false;
+    released = micros();
+}
+
+/*
+    Wait for the slave's ready output before each frame, at most timeoutMs
+    milliseconds. pin 0 switches the check off.
+*/
+void SPIMasterBlockClass::setReadyPin(uint8_t pin, uint8_t activeLevel, uint16_t timeoutMs)
+{
+    uint8_t port = (pin != 0) ? digitalPinToPort(pin) : NOT_A_PORT;
+
+    readyMs = timeoutMs;
+    if (port == NOT_A_PORT)
+    {
+        readyIn = &portNone;
+        readyMask = 0;
+        readyBits = 0;
+        return;
+    }
+    pinMode(pin, INPUT);
+    readyIn = portInputRegister(port);
+    readyMask = digitalPinToBitMask(pin);
+    readyBits = (activeLevel == HIGH) ? readyMask : 0;
+}
+
+/*
+    Minimal CS high time between two frames in us. Covers the slave's
+    re-arm time when no ready pin is used, and the ISR latency until the
+    slave drops its ready output when one is.
+*/
+void SPIMasterBlockClass::setGap(uint16_t us)
+{
+    gapUs = us;
+}
+
+bool SPIMasterBlockClass::usesDMA(void)
+{
+    return (dma);
+}
+
+/*
+    Assert CS and start clocking count bytes, returns at once; done()
+    releases CS when the frame is through. On DMA the frame runs on its
+    own, with byte transfers each done() call clocks the next byte.
+    Either buffer may be 0, 0xFF is sent and received bytes are dropped.
+    Returns false, with CS not asserted, if the slave did not signal
+    ready within the ready timeout.
+*/
+bool SPIMasterBlockClass::start(uint8_t *rxbuf, const uint8_t *txbuf, uint16_t count)
+{
+    uint32_t wait;
+
+    while (running && !done());
+    while ((uint32_t)(micros() - released) < gapUs);
+    wait = millis();
+    while ((*readyIn & readyMask) != readyBits)
+    {
+        if ((uint32_t)(millis() - wait) >= readyMs)
+        {
+            return (false);
+        }
+    }
+
+    select(true);
+    running = true;
+    if (dma)
+    {
+        spi_master_block_start(rxbuf, txbuf, count);
+        return (true);
+    }
+    rxNext = rxbuf;
+    txNext = txbuf;
+    left = count;
+    return (true);
+}
+
+/*
+    The frame started by start() is complete, CS is released.
+*/
+bool SPIMasterBlockClass::done(void)
+{
+    uint8_t in;
+
+    if (!running)
+    {
+        return (true);
+    }
+    if (dma && spi_master_block_busy())
+    {
+        return (false);
+    }
+    if (!dma && left)
+    {
+        in = SPI.transfer(txNext ? *txNext++ : 0xFF);
+        if (rxNext)
+        {
+            *rxNext++ = in;
+        }
+        left--;
+        return (false);
+    }
+    running = false;
+    select(false);
+    return (true);
+}
+
+/*
+    Clock one frame and wait for it. Returns false if the slave did not
+    get ready, see start().
+*/
+bool SPIMasterBlockClass::transfer(uint8_t *rxbuf, const uint8_t *txbuf, uint16_t count)
+{
+    if (!start(rxbuf, txbuf, count))
+    {
+        return (false);
+    }
+    while (!done());
+    return (true);
+}
+
+/*
+    Pre-Initialize a SPI Master Block instance
+*/
+SPIMasterBlockClass SPIMasterBlock;
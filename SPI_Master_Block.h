@@ -0,0 +1,74 @@
+/*
+    SPI_Master_Block.h - block transfers on the master side of the link
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+    Companion of SPISlave for the device that drives the bus. The module
+    is set up as master by the SPI library (SPI.begin(), clock divider and
+    data mode as usual), a whole frame is then clocked by DMA between one
+    CS assert and release. Without a DMA channel pair for the module the
+    frame falls back to SPI.transfer(), one byte per done() call, so
+    start() does not block on either path.
+
+    Before a frame the master waits for the slave's ready output (see
+    SPISlave.setReadyPin()) and for a minimal CS high time, so the slave
+    gets time to re-arm between back to back frames. A slave that does
+    not get ready within the ready timeout fails the frame, CS is then
+    not asserted.
+
+*/
+
+#ifndef _SPIMASTER_BLOCK_H_INCLUDED
+#define _SPIMASTER_BLOCK_H_INCLUDED
+
+#include <Energia.h>
+#include <inttypes.h>
+#include "SPI_Slave.h"
+
+#if defined(DEFAULT_SPI)
+#define SPI_MASTER_BLOCK_MODULE DEFAULT_SPI
+#else
+#define SPI_MASTER_BLOCK_MODULE 0
+#endif
+
+#define SPI_MASTER_BLOCK_READY_MS 10   /* default wait for the slave's ready output */
+
+class SPIMasterBlockClass
+{
+  private:
+    static volatile uint8_t *csOut;
+    static uint8_t csMask;
+    static uint8_t csActiveBits;   /* csMask if CS is active high, 0 if active low */
+    static volatile uint8_t *readyIn;
+    static uint8_t readyMask;
+    static uint8_t readyBits;      /* readyMask if ready is active high */
+    static uint16_t readyMs;       /* ready timeout */
+    static uint8_t portNone;       /* stands in for unused pins */
+    static uint16_t gapUs;
+    static uint32_t released;      /* micros() of the last CS release */
+    static bool dma;
+    static bool running;
+    static uint8_t *rxNext;        /* byte transfers: done() clocks the next byte */
+    static const uint8_t *txNext;
+    static uint16_t left;
+
+    static void select(bool on);
+
+  public:
+    /* call after SPI.begin(); module is the SPI library's module */
+    static void begin(uint8_t csPin, uint8_t module = SPI_MASTER_BLOCK_MODULE, uint8_t csActiveLevel = LOW);
+    static void setReadyPin(uint8_t pin, uint8_t activeLevel = HIGH, uint16_t timeoutMs = SPI_MASTER_BLOCK_READY_MS);
+    static void setGap(uint16_t us);
+    static bool usesDMA(void);
+
+    static bool transfer(uint8_t *rxbuf, const uint8_t *txbuf, uint16_t count);
+    static bool start(uint8_t *rxbuf, const uint8_t *txbuf, uint16_t count);
+    static bool done(void);
+};
+
+extern SPIMasterBlockClass SPIMasterBlock;
+
+#endif
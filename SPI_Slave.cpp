@@ -11,13 +11,36 @@
 
 */
 
+#include <string.h>
 #include <Energia.h>
 
 #include "SPI_Slave.h"
 
+volatile uint8_t *SPISlaveClass::csIn = &SPISlaveClass::csNone;
+uint8_t SPISlaveClass::csPin = 0;
+uint8_t SPISlaveClass::csMask = 0;
+uint8_t SPISlaveClass::csActiveBits = 0;
+volatile bool SPISlaveClass::csEdge = false;
+uint8_t SPISlaveClass::csNone = 0;
+bool SPISlaveClass::csLatch = false;
+void (*SPISlaveClass::csHandler)(void) = 0;
+uint16_t SPISlaveClass::timeoutMs = 0;
+bool SPISlaveClass::timeoutOnCS = false;
+uint8_t SPISlaveClass::error = SPI_SLAVE_OK;
+uint16_t SPISlaveClass::partial = 0;
+#if SPI_SLAVE_STREAM
+uint8_t *SPISlaveClass::streamBuf = 0;
+uint16_t SPISlaveClass::streamSize = 0;
+uint32_t SPISlaveClass::streamRead = 0;
+uint16_t SPISlaveClass::streamTail = 0;
+uint32_t SPISlaveClass::streamLostBytes = 0;
+#endif
+
 SPISlaveClass::SPISlaveClass(void)
 {
-#if defined(DEFAULT_SPI)
+#if (SPI_SLAVE_ONLY_MODULE != 0xFF)
+    setModule(SPI_SLAVE_ONLY_MODULE);
+#elif defined(DEFAULT_SPI)
     setModule(DEFAULT_SPI);
 #else
     setModule(0);
@@ -27,49 +50,49 @@ SPISlaveClass::SPISlaveClass(void)
 void SPISlaveClass::setModule(uint8_t module)
 {
     spiSlaveModule = module;
-#if defined(__MSP430_HAS_EUSCI_B0__)
+#if defined(UCB0_BASE) && SPI_SLAVE_MODULE_USED(0)
     if (module == 0)
     {
         SPI_slave_baseAddress = UCB0_BASE;
     }
 #endif
-#if defined(__MSP430_HAS_EUSCI_B1__)
+#if defined(UCB1_BASE) && SPI_SLAVE_MODULE_USED(1)
     if (module == 1)
     {
         SPI_slave_baseAddress = UCB1_BASE;
     }
 #endif
-#if defined(__MSP430_HAS_EUSCI_B2__)
+#if defined(UCB2_BASE) && SPI_SLAVE_MODULE_USED(2)
     if (module == 2)
     {
         SPI_slave_baseAddress = UCB2_BASE;
     }
 #endif
-#if defined(__MSP430_HAS_EUSCI_B3__)
+#if defined(UCB3_BASE) && SPI_SLAVE_MODULE_USED(3)
     if (module == 3)
     {
         SPI_slave_baseAddress = UCB3_BASE;
     }
 #endif
-#if defined(__MSP430_HAS_EUSCI_A0__)
+#if defined(UCA0_BASE) && SPI_SLAVE_MODULE_USED(10)
     if (module == 10)
     {
         SPI_slave_baseAddress = UCA0_BASE;
     }
 #endif
-#if defined(__MSP430_HAS_EUSCI_A1__)
+#if defined(UCA1_BASE) && SPI_SLAVE_MODULE_USED(11)
     if (module == 11)
     {
         SPI_slave_baseAddress = UCA1_BASE;
     }
 #endif
-#if defined(__MSP430_HAS_EUSCI_A2__)
+#if defined(UCA2_BASE) && SPI_SLAVE_MODULE_USED(12)
     if (module == 12)
     {
         SPI_slave_baseAddress = UCA2_BASE;
     }
 #endif
-#if defined(__MSP430_HAS_EUSCI_A3__)
+#if defined(UCA3_BASE) && SPI_SLAVE_MODULE_USED(13)
     if (module == 13)
     {
         SPI_slave_baseAddress = UCA3_BASE;
@@ -77,116 +100,369 @@ void SPISlaveClass::setModule(uint8_t module)
 #endif
 }
 
+#if defined(DEFAULT_SPI) && !defined(__MSP430_HAS_USI__)
+/*
+    Pins of every module the board brings out, from pins_energia.h. A new
+    module or board only needs an entry here.
+*/
+typedef struct
+{
+    uint16_t base;  /* module base address */
+    uint8_t  sck;
+    uint8_t  mosi;
+    uint8_t  miso;
+    uint8_t  ss;    /* STE, only used in 4 wire mode */
+    uint16_t sck_sel;   /* pin functions, SPIxxxn_SET_MODE */
+    uint16_t mosi_sel;
+    uint16_t miso_sel;
+} spi_slave_pins_t;
+
+static const spi_slave_pins_t spi_slave_pins[] =
+{
+#if defined(UCB0_BASE) && defined(SPISCK0_SET_MODE) && SPI_SLAVE_MODULE_USED(0)
+    { UCB0_BASE, SCK0, MOSI0, MISO0, SS0, SPISCK0_SET_MODE, SPIMOSI0_SET_MODE, SPIMISO0_SET_MODE },
+#endif
+#if defined(UCB1_BASE) && defined(SPISCK1_SET_MODE) && SPI_SLAVE_MODULE_USED(1)
+    { UCB1_BASE, SCK1, MOSI1, MISO1, SS1, SPISCK1_SET_MODE, SPIMOSI1_SET_MODE, SPIMISO1_SET_MODE },
+#endif
+#if defined(UCB2_BASE) && defined(SPISCK2_SET_MODE) && SPI_SLAVE_MODULE_USED(2)
+    { UCB2_BASE, SCK2, MOSI2, MISO2, SS2, SPISCK2_SET_MODE, SPIMOSI2_SET_MODE, SPIMISO2_SET_MODE },
+#endif
+#if defined(UCB3_BASE) && defined(SPISCK3_SET_MODE) && SPI_SLAVE_MODULE_USED(3)
+    { UCB3_BASE, SCK3, MOSI3, MISO3, SS3, SPISCK3_SET_MODE, SPIMOSI3_SET_MODE, SPIMISO3_SET_MODE },
+#endif
+#if defined(UCA0_BASE) && defined(SPISCK10_SET_MODE) && SPI_SLAVE_MODULE_USED(10)
+    { UCA0_BASE, SCK10, MOSI10, MISO10, SS10, SPISCK10_SET_MODE, SPIMOSI10_SET_MODE, SPIMISO10_SET_MODE },
+#endif
+#if defined(UCA1_BASE) && defined(SPISCK11_SET_MODE) && SPI_SLAVE_MODULE_USED(11)
+    { UCA1_BASE, SCK11, MOSI11, MISO11, SS11, SPISCK11_SET_MODE, SPIMOSI11_SET_MODE, SPIMISO11_SET_MODE },
+#endif
+#if defined(UCA2_BASE) && defined(SPISCK12_SET_MODE) && SPI_SLAVE_MODULE_USED(12)
+    { UCA2_BASE, SCK12, MOSI12, MISO12, SS12, SPISCK12_SET_MODE, SPIMOSI12_SET_MODE, SPIMISO12_SET_MODE },
+#endif
+#if defined(UCA3_BASE) && defined(SPISCK13_SET_MODE) && SPI_SLAVE_MODULE_USED(13)
+    { UCA3_BASE, SCK13, MOSI13, MISO13, SS13, SPISCK13_SET_MODE, SPIMOSI13_SET_MODE, SPIMISO13_SET_MODE },
+#endif
+    { 0, 0, 0, 0, 0, 0, 0, 0 }  /* keeps the table non-empty */
+};
+
+#define SPI_SLAVE_PIN_ENTRIES (sizeof(spi_slave_pins) / sizeof(spi_slave_pins[0]) - 1)
+#endif
+
 void SPISlaveClass::initPins(const uint8_t mode)
 {
     /* Set pins to SPI mode. */
-#if defined(DEFAULT_SPI)
-#if defined(UCB0_BASE) && defined(SPISCK0_SET_MODE)
-    if (SPI_slave_baseAddress == UCB0_BASE)
-    {
-        pinMode_int(SCK0, SPISCK0_SET_MODE);
-        pinMode_int(MOSI0, SPIMOSI0_SET_MODE);
-        pinMode_int(MISO0, SPIMISO0_SET_MODE);
-        if (mode > 0)
-        {
-            pinMode_int(SS0, SPISCK0_SET_MODE); // STE=/CS
-        }
+#if defined(__MSP430_HAS_USI__)
+    /* SCLK/SDO/SDI are switched by USIPEx, the USI has no STE input */
+    if (MODE_HAS_CS(mode))
+    {
+        pinMode(SS, INPUT);
     }
-#endif
-#if defined(UCB1_BASE) && defined(SPISCK1_SET_MODE)
-    if (SPI_slave_baseAddress == UCB1_BASE)
+    setCSPin(MODE_HAS_CS(mode) ? SS : 0, (mode == MODE_4WIRE_STE1) ? HIGH : LOW);
+#elif defined(DEFAULT_SPI)
+    const spi_slave_pins_t *p;
+    for (p = spi_slave_pins; p < spi_slave_pins + SPI_SLAVE_PIN_ENTRIES; p++)
     {
-        pinMode_int(SCK1, SPISCK1_SET_MODE);
-        pinMode_int(MOSI1, SPIMOSI1_SET_MODE);
-        pinMode_int(MISO1, SPIMISO1_SET_MODE);
-        if (mode > 0)
+        if (p->base == SPI_slave_baseAddress)
         {
-            pinMode_int(SS1, SPISCK1_SET_MODE); // STE=/CS
+            pinMode_int(p->sck, p->sck_sel);
+            pinMode_int(p->mosi, p->mosi_sel);
+            initDataPin(mode, p->miso, p->miso_sel);
+            if (MODE_HAS_CS(mode))
+            {
+                pinMode_int(p->ss, p->sck_sel); // STE=/CS
+            }
+            setCSPin(MODE_HAS_CS(mode) ? p->ss : 0, (mode == MODE_4WIRE_STE1) ? HIGH : LOW);
+            break;
         }
     }
-#endif
-#if defined(UCB2_BASE) && defined(SPISCK2_SET_MODE)
-    if (SPI_slave_baseAddress == UCB2_BASE)
+#else
+    pinMode_int(SCK, SPISCK_SET_MODE);
+    pinMode_int(MOSI, SPIMOSI_SET_MODE);
+    initDataPin(mode, MISO, SPIMISO_SET_MODE);
+    if (MODE_HAS_CS(mode))
     {
-        pinMode_int(SCK2, SPISCK2_SET_MODE);
-        pinMode_int(MOSI2, SPIMOSI2_SET_MODE);
-        pinMode_int(MISO2, SPIMISO2_SET_MODE);
-        if (mode > 0)
-        {
-            pinMode_int(SS2, SPISCK2_SET_MODE); // STE=/CS
-        }
+        pinMode_int(SS, SPISCK_SET_MODE); // STE=/CS
     }
+    setCSPin(MODE_HAS_CS(mode) ? SS : 0, (mode == MODE_4WIRE_STE1) ? HIGH : LOW);
 #endif
-#if defined(UCB3_BASE) && defined(SPISCK3_SET_MODE)
-    if (SPI_slave_baseAddress == UCB3_BASE)
+}
+
+/*
+    MISO is driven by the module, except on the single data line of
+    MODE_3WIRE_HALF: there the backend switches it at the turnaround.
+*/
+void SPISlaveClass::initDataPin(const uint8_t mode, uint8_t pin, uint16_t pin_mode)
+{
+#if SPI_SLAVE_HALF_DUPLEX
+    if (mode == MODE_3WIRE_HALF)
     {
-        pinMode_int(SCK3, SPISCK3_SET_MODE);
-        pinMode_int(MOSI3, SPIMOSI3_SET_MODE);
-        pinMode_int(MISO3, SPIMISO3_SET_MODE);
-        if (mode > 0)
-        {
-            pinMode_int(SS3, SPISCK3_SET_MODE); // STE=/CS
-        }
+        spi_slave_set_data_pin(pin, pin_mode);
+        return;
     }
+    spi_slave_set_data_pin(0, 0);
+#else
+    (void)mode;
 #endif
-#if defined(UCA0_BASE) && defined(SPISCK10_SET_MODE)
-    if (SPI_slave_baseAddress == UCA0_BASE)
+    pinMode_int(pin, pin_mode);
+}
+
+void SPISlaveClass::onCSRelease(void)
+{
+    csEdge = true;
+    if (csHandler)
     {
-        pinMode_int(SCK10, SPISCK10_SET_MODE);
-        pinMode_int(MOSI10, SPIMOSI10_SET_MODE);
-        pinMode_int(MISO10, SPIMISO10_SET_MODE);
-        if (mode > 0)
-        {
-            pinMode_int(SS10, SPISCK10_SET_MODE); // STE=/CS
-        }
+        csHandler();
     }
-#endif
-#if defined(UCA1_BASE) && defined(SPISCK11_SET_MODE)
-    if (SPI_slave_baseAddress == UCA1_BASE)
+}
+
+/*
+    (Re)attach the port interrupt of the CS pin for the latch and the
+    handler, both are kept across setCSPin() and begin().
+*/
+void SPISlaveClass::attachCSInterrupt(void)
+{
+    if (csPin == 0)
     {
-        pinMode_int(SCK11, SPISCK11_SET_MODE);
-        pinMode_int(MOSI11, SPIMOSI11_SET_MODE);
-        pinMode_int(MISO11, SPIMISO11_SET_MODE);
-        if (mode > 0)
-        {
-            pinMode_int(SS11, SPISCK11_SET_MODE); // STE=/CS
-        }
+        return;
     }
-#endif
-#if defined(UCA2_BASE) && defined(SPISCK12_SET_MODE)
-    if (SPI_slave_baseAddress == UCA2_BASE)
+    if (csLatch)
     {
-        pinMode_int(SCK12, SPISCK12_SET_MODE);
-        pinMode_int(MOSI12, SPIMOSI12_SET_MODE);
-        pinMode_int(MISO12, SPIMISO12_SET_MODE);
-        if (mode > 0)
-        {
-            pinMode_int(SS12, SPISCK12_SET_MODE); // STE=/CS
-        }
+        ::attachInterrupt(csPin, onCSRelease, csActiveBits ? FALLING : RISING);
     }
-#endif
-#if defined(UCA3_BASE) && defined(SPISCK13_SET_MODE)
-    if (SPI_slave_baseAddress == UCA3_BASE)
+    else if (csHandler)
+    {
+        ::attachInterrupt(csPin, csHandler, csActiveBits ? FALLING : RISING);
+    }
+    else
+    {
+        ::detachInterrupt(csPin);
+    }
+}
+
+/*
+    Latch the CS release edge in a port interrupt, so the end of a frame
+    is seen by csReleased() even when the loop polls too slowly to catch
+    the CS pulse. The CS pin has to be interrupt capable.
+*/
+void SPISlaveClass::latchCSRelease(bool enable)
+{
+    csLatch = enable;
+    csEdge = false;
+    attachCSInterrupt();
+}
+
+/*
+    Call handler in the port interrupt of every CS release edge, 0 detaches
+    it. Shares the port interrupt with latchCSRelease(). Returns false if
+    there is no CS pin, the handler is then never called.
+*/
+bool SPISlaveClass::attachCSRelease(void (*handler)(void))
+{
+    csHandler = handler;
+    attachCSInterrupt();
+    return (csPin != 0);
+}
+
+/*
+    Drop the transfer in progress, it is not re-armed.
+*/
+uint16_t SPISlaveClass::abort(void)
+{
+    partial = spi_slave_abort();
+    error = SPI_SLAVE_ABORTED;
+    return (partial);
+}
+
+void SPISlaveClass::recover(uint8_t code)
+{
+    abort();
+    error = code;
+    spi_slave_rearm();
+}
+
+/*
+    The frame timer starts with the first received byte, so an idle bus
+    never times out. Returns true if the frame was aborted.
+*/
+bool SPISlaveClass::checkTimeout(void)
+{
+    uint32_t start;
+
+    if (!spi_slave_frame_started(&start))
+    {
+        return (false);
+    }
+    if (timeoutOnCS && !csActive() && !spi_data_done())
+    {
+        recover(SPI_SLAVE_CS_ABORT);
+        return (true);
+    }
+    if (timeoutMs && ((uint32_t)(millis() - start) >= timeoutMs))
+    {
+        recover(SPI_SLAVE_TIMEOUT);
+        return (true);
+    }
+    return (false);
+}
+
+/*
+    Check the timeout set by setTimeout() without transactionDone(), for
+    frames taken through a layer (Packet, Queue, ...) that re-arms the
+    slave from its hooks; call it from loop(). Returns true if a frame
+    was aborted, lastError() tells why.
+*/
+bool SPISlaveClass::poll(void)
+{
+    if ((timeoutMs || timeoutOnCS) && !spi_data_done())
+    {
+        return (checkTimeout());
+    }
+    return (false);
+}
+
+#if SPI_SLAVE_STREAM
+/*
+    Receive without frames into the ring buf, drained from loop() with
+    readBlock() or peekContiguous() / consume(). The ring is written by
+    spi_rx_isr() or the DMA, the read side lives here: the producer count
+    is sampled with interrupts off and the consumer index is only touched
+    by loop(), so neither side needs a lock. The producer never waits for
+    the consumer, size the ring for the longest gap between two drains.
+*/
+void SPISlaveClass::stream(uint8_t *buf, uint16_t size)
+{
+    streamBuf = buf;
+    streamSize = size;
+    streamRead = 0;
+    streamTail = 0;
+    streamLostBytes = 0;
+    spi_slave_stream(buf, size);
+}
+
+/*
+    Unread bytes in the ring. When the producer has lapped the consumer
+    the oldest data is gone: the read side skips ahead to the newest half
+    of the ring, so it has headroom again, and counts the skipped bytes.
+*/
+uint16_t SPISlaveClass::streamAvailable(void)
+{
+    uint32_t pending;
+    uint32_t skip;
+
+    if (streamSize == 0)
+    {
+        return (0);
+    }
+    pending = spi_slave_stream_count() - streamRead;
+    if (pending > streamSize)
+    {
+        skip = pending - (streamSize / 2);
+        streamLostBytes += skip;
+        streamRead += skip;
+        streamTail = (uint16_t)((streamTail + skip) % streamSize);
+        pending = streamSize / 2;
+    }
+    return ((uint16_t)pending);
+}
+
+/*
+    Zero copy access: *ptr is set to the oldest unread byte, the return
+    value is the number of bytes readable there without a wrap. The bytes
+    stay valid until consume() and until the producer laps the ring.
+*/
+uint16_t SPISlaveClass::peekContiguous(uint8_t **ptr)
+{
+    uint16_t count = streamAvailable();
+    uint16_t span = streamSize - streamTail;
+
+    *ptr = streamBuf + streamTail;
+    return ((count < span) ? count : span);
+}
+
+/*
+    Hand count bytes back to the producer.
+*/
+void SPISlaveClass::consume(uint16_t count)
+{
+    uint16_t available = streamAvailable();
+
+    if (count > available)
+    {
+        count = available;
+    }
+    streamRead += count;
+    streamTail += count;
+    if (streamTail >= streamSize)
     {
-        pinMode_int(SCK13, SPISCK13_SET_MODE);
-        pinMode_int(MOSI13, SPIMOSI13_SET_MODE);
-        pinMode_int(MISO13, SPIMISO13_SET_MODE);
-        if (mode > 0)
+        streamTail -= streamSize;
+    }
+}
+
+/*
+    Copy up to max unread bytes to dst. At most two block copies, one per
+    contiguous span; memcpy moves words when both sides are aligned.
+    Returns the number of bytes copied.
+*/
+uint16_t SPISlaveClass::readBlock(uint8_t *dst, uint16_t max)
+{
+    uint16_t total = 0;
+    uint16_t count;
+    uint8_t *src;
+
+    while (total < max)
+    {
+        count = peekContiguous(&src);
+        if (count == 0)
         {
-            pinMode_int(SS13, SPISCK13_SET_MODE); // STE=/CS
+            break;
         }
+        if (count > (max - total))
+        {
+            count = max - total;
+        }
+        memcpy(dst + total, src, count);
+        consume(count);
+        total += count;
     }
+    return (total);
+}
 #endif
-#else
-    pinMode_int(SCK, SPISCK_SET_MODE);
-    pinMode_int(MOSI, SPIMOSI_SET_MODE);
-    pinMode_int(MISO, SPIMISO_SET_MODE);
-    if (mode > 0)
+
+#if SPI_SLAVE_TRACE
+/*
+    Print the trace ring, oldest record first, one line per transfer:
+    seq start_us duration_us count received flags data...
+    (all hex).
+*/
+void SPISlaveClass::traceDump(Print &out)
+{
+    spi_slave_trace_t t;
+    uint8_t i;
+    uint8_t j;
+
+    for (i = 0; spi_slave_trace_read(i, &t); i++)
     {
-        pinMode_int(SS, SPISCK_SET_MODE); // STE=/CS
+        out.print(t.seq, HEX);
+        out.print(' ');
+        out.print(t.start, HEX);
+        out.print(' ');
+        out.print(t.duration, HEX);
+        out.print(' ');
+        out.print(t.count, HEX);
+        out.print(' ');
+        out.print(t.received, HEX);
+        out.print(' ');
+        out.print(t.flags, HEX);
+        for (j = 0; j < SPI_SLAVE_TRACE_BYTES; j++)
+        {
+            out.print(' ');
+            out.print(t.data[j], HEX);
+        }
+        out.println();
     }
-#endif
 }
+#endif
 
 /*
     Pre-Initialize a SPI instances
@@ -19,6 +19,9 @@
 
 #if defined(__MSP430_HAS_USI__) || defined(__MSP430_HAS_USCI_B0__) || defined(__MSP430_HAS_USCI_B1__) || defined(__MSP430_HAS_USCI__) || defined(__MSP430_HAS_EUSCI_B0__) || defined(__MSP430_HAS_EUSCI_B1__) || defined(__MSP430_HAS_EUSCI_B2__) || defined(__MSP430_HAS_EUSCI_B3__) || defined(DEFAULT_SPI)
 #include "utility/spi_slave_430.h"
+#include "utility/spi_slave_trace.h"
+#include "utility/spi_slave_stats.h"
+#include "utility/spi_slave_clock.h"
 #endif
 
 #define SPI_MODE0 0
@@ -29,6 +32,16 @@
 #define MODE_3WIRE      0
 #define MODE_4WIRE_STE1 1
 #define MODE_4WIRE_STE0 2
+#define MODE_3WIRE_HALF 3   /* 3 wire, MOSI and MISO on one data line, see halfDuplex() */
+
+/* wire modes with an STE/CS pin */
+#define MODE_HAS_CS(mode) (((mode) == MODE_4WIRE_STE1) || ((mode) == MODE_4WIRE_STE0))
+
+/* lastError() codes */
+#define SPI_SLAVE_OK        0
+#define SPI_SLAVE_TIMEOUT   1   /* frame not completed within the timeout */
+#define SPI_SLAVE_CS_ABORT  2   /* CS released before the frame was complete */
+#define SPI_SLAVE_ABORTED   3   /* abort() called */
 
 
 #if defined(__MSP430_HAS_USCI_B0__)
@@ -44,6 +57,23 @@
 #define UCB3_BASE __MSP430_BASEADDRESS_USCI_B3__
 #endif
 
+#if defined(__MSP430_HAS_USCI_A0__)
+#define UCA0_BASE __MSP430_BASEADDRESS_USCI_A0__
+#endif
+#if defined(__MSP430_HAS_USCI_A1__)
+#define UCA1_BASE __MSP430_BASEADDRESS_USCI_A1__
+#endif
+#if defined(__MSP430_HAS_USCI_A2__)
+#define UCA2_BASE __MSP430_BASEADDRESS_USCI_A2__
+#endif
+#if defined(__MSP430_HAS_USCI_A3__)
+#define UCA3_BASE __MSP430_BASEADDRESS_USCI_A3__
+#endif
+#if defined(__MSP430_HAS_USCI__)
+#define UCA0_BASE 0x0060
+#define UCB0_BASE 0x0068
+#endif
+
 #if defined(__MSP430_HAS_EUSCI_B0__)
 #define UCB0_BASE __MSP430_BASEADDRESS_EUSCI_B0__
 #endif
@@ -101,7 +131,34 @@ extern uint8_t spiSlaveModule ;
 class SPISlaveClass
 {
   private:
+    static volatile uint8_t *csIn;  /* PxIN of the CS pin */
+    static uint8_t csPin;
+    static uint8_t csMask;
+    static uint8_t csActiveBits;     /* csMask if CS is active high, 0 if active low */
+    static volatile bool csEdge;
+    static uint8_t csNone;           /* reads as 0 when there is no CS pin */
+    static bool csLatch;             /* latchCSRelease() */
+    static void (*csHandler)(void);  /* attachCSRelease() */
+
+    static uint16_t timeoutMs;
+    static bool timeoutOnCS;
+    static uint8_t error;
+    static uint16_t partial;
+
+#if SPI_SLAVE_STREAM
+    static uint8_t *streamBuf;       /* ring given to stream() */
+    static uint16_t streamSize;
+    static uint32_t streamRead;      /* bytes consumed, modulo 2^32 */
+    static uint16_t streamTail;      /* ring offset of the oldest unread byte */
+    static uint32_t streamLostBytes;
+#endif
+
     void initPins(const uint8_t mode);
+    static void initDataPin(const uint8_t mode, uint8_t pin, uint16_t pin_mode);
+    static void onCSRelease(void);
+    static void attachCSInterrupt(void);
+    static bool checkTimeout(void);
+    static void recover(uint8_t code);
 
   public:
 
@@ -109,8 +166,44 @@ class SPISlaveClass
     inline static size_t bytes_to_transmit(void);
     inline static size_t bytes_received(void);
     inline static int getCS(uint8_t pin);
+    inline static void setCSPin(uint8_t pin, uint8_t activeLevel = LOW);
+    inline static bool csActive(void);
+    inline static bool csReleased(void);
+    static void latchCSRelease(bool enable);
+    static bool attachCSRelease(void (*handler)(void));
+    inline static void setTimeout(uint16_t ms, bool onCSRelease = false);
+    static bool poll(void);
+    inline static uint8_t lastError(void);
+    inline static uint16_t partialLength(void);
+    static uint16_t abort(void);
+#if SPI_SLAVE_TRACE
+    static void traceDump(Print &out);
+#endif
+#if SPI_SLAVE_STATS
+    inline static void readStats(spi_slave_stats_t &stats);
+    inline static void clearStats(void);
+#endif
     inline static void transfer(uint8_t *buf, size_t count);
     inline static void transfer(uint8_t *rxbuf, uint8_t *txbuf, size_t count);
+    inline static void echo(uint8_t xorMask = 0, uint8_t increment = 0);
+#if SPI_SLAVE_HALF_DUPLEX
+    inline static void halfDuplex(uint8_t *rxbuf, uint16_t rxCount, uint8_t *txbuf, uint16_t txCount);
+    inline static void setTurnaroundCallback(uint16_t (*callback)(uint8_t *command));
+#endif
+#if SPI_SLAVE_STREAM
+    static void stream(uint8_t *buf, uint16_t size);
+    static uint16_t streamAvailable(void);
+    static uint16_t peekContiguous(uint8_t **ptr);
+    static void consume(uint16_t count);
+    static uint16_t readBlock(uint8_t *dst, uint16_t max);
+    inline static uint32_t streamLost(void);
+#endif
+    inline static void setReadyPin(uint8_t pin, uint8_t activeLevel = HIGH);
+    inline static bool usesDMA(void);
+    inline static uint8_t scaleMclk(uint32_t sckHz, uint32_t framesPerS);
+    inline static uint8_t setMclkShift(uint8_t shift);
+    inline static uint8_t mclkShift(void);
+    inline static void setStatusCallback(uint8_t (*callback)(void));
 
     // SPI Configuration methods
     SPISlaveClass(void);
@@ -119,6 +212,7 @@ class SPISlaveClass
     inline static void begin(uint8_t module);
     inline static void begin(SPISlaveSettings settings, uint8_t module);
     inline static void begin(SPISlaveSettings settings, uint8_t module, uint8_t sck, uint8_t mosi, uint8_t miso, uint8_t cs, uint8_t pin_mode);
+    inline static void reconfigure(SPISlaveSettings settings);
     inline static void end();
 
     inline static void attachInterrupt();
@@ -157,19 +251,33 @@ void SPISlaveClass::begin(SPISlaveSettings settings, uint8_t module, uint8_t sck
 {
     pinMode_int(sck,  pin_mode); // SCK
     pinMode_int(mosi, pin_mode); // MOSI
-    pinMode_int(miso, pin_mode); // MISO
+    initDataPin(settings._mode, miso, pin_mode); // MISO
     if (cs > 0)
     {
         pinMode_int(cs, pin_mode); // STE=/CS
     }
+    setCSPin(cs, (settings._mode == MODE_4WIRE_STE1) ? HIGH : LOW);
 
     SPISlave.setModule(module);
     spi_slave_initialize(settings._mode, settings._datamode, settings._bitOrder);
 }
 
+/*
+    Switch SPI mode, bit order or wire mode on the running module. DMA
+    setup is kept; the pins are only touched when the wire mode changes.
+    Arm the next transfer afterwards.
+*/
+void SPISlaveClass::reconfigure(SPISlaveSettings settings)
+{
+    if (spi_slave_reconfigure(settings._mode, settings._datamode, settings._bitOrder))
+    {
+        SPISlave.initPins(settings._mode);
+    }
+}
+
 void SPISlaveClass::transfer(uint8_t *buf, size_t count)
 {
-    spi_slave_transfer(buf, buf, count);
+    transfer(buf, buf, count);
 }
 
 void SPISlaveClass::transfer(uint8_t *rxbuf, uint8_t *txbuf, size_t count)
@@ -177,13 +285,155 @@ void SPISlaveClass::transfer(uint8_t *rxbuf, uint8_t *txbuf, size_t count)
     spi_slave_transfer(rxbuf, txbuf, count);
 }
 
+void SPISlaveClass::echo(uint8_t xorMask, uint8_t increment)
+{
+    spi_slave_echo(xorMask, increment);
+}
+
+#if SPI_SLAVE_HALF_DUPLEX
+/*
+    One frame on a single data line: rxCount command bytes from the
+    master, then txCount response bytes. In MODE_3WIRE_HALF MISO is only
+    driven after the turnaround; wire MOSI and MISO to the master's data
+    line and let the master pause SCK at the turnaround long enough for
+    the slave to switch (turn_ns in utility/spi_slave_timing.h). Done
+    when transactionDone(), a timeout does not re-arm it.
+*/
+void SPISlaveClass::halfDuplex(uint8_t *rxbuf, uint16_t rxCount, uint8_t *txbuf, uint16_t txCount)
+{
+    spi_slave_half_duplex(rxbuf, rxCount, txbuf, txCount);
+}
+
+/*
+    Called at the turnaround with the command, in interrupt context. It
+    may fill the response buffer of halfDuplex() and returns the number
+    of bytes to send, at most txCount.
+*/
+void SPISlaveClass::setTurnaroundCallback(uint16_t (*callback)(uint8_t *command))
+{
+    spi_slave_set_turn_hook(callback);
+}
+#endif
+
+#if SPI_SLAVE_STREAM
+/*
+    Bytes the consumer fell behind by and that were overwritten in the
+    ring, see streamAvailable().
+*/
+uint32_t SPISlaveClass::streamLost(void)
+{
+    return (streamLostBytes);
+}
+#endif
+
+void SPISlaveClass::setReadyPin(uint8_t pin, uint8_t activeLevel)
+{
+    spi_slave_set_ready_pin(pin, activeLevel);
+}
+
+bool SPISlaveClass::usesDMA(void)
+{
+    return (spi_slave_uses_dma() != 0);
+}
+
+/*
+    Lower MCLK to the slowest F_CPU >> n that still keeps up with sckHz
+    and framesPerS, see utility/spi_slave_clock.h. Returns n.
+*/
+uint8_t SPISlaveClass::scaleMclk(uint32_t sckHz, uint32_t framesPerS)
+{
+    return (spi_slave_mclk_scale(sckHz, framesPerS, spi_slave_uses_dma()));
+}
+
+/*
+    Run MCLK at F_CPU >> shift, 0 restores the full clock.
+*/
+uint8_t SPISlaveClass::setMclkShift(uint8_t shift)
+{
+    return (spi_slave_mclk_set_divider(shift));
+}
+
+uint8_t SPISlaveClass::mclkShift(void)
+{
+    return (spi_slave_mclk_divider());
+}
+
+void SPISlaveClass::setStatusCallback(uint8_t (*callback)(void))
+{
+    spi_slave_set_status_hook(callback);
+}
+
 bool SPISlaveClass::transactionDone(void)
 {
-    return (spi_data_done());
+    if (spi_data_done())
+    {
+        return (true);
+    }
+    if (timeoutMs || timeoutOnCS)
+    {
+        checkTimeout();
+    }
+    return (false);
+}
+
+/*
+    Abort a frame that has started but not completed within ms
+    milliseconds, or (onCSRelease) whose CS was released early. Checked
+    by transactionDone() and poll(); the transfer is re-armed with the
+    buffers it was last armed with, also when a layer armed it from its
+    hooks. The time runs from the first byte, stamped by the backend;
+    a DMA transfer without header hook takes no interrupt before it
+    completes, its time runs from the first transactionDone() or poll()
+    that sees bytes in. ms = 0 and onCSRelease = false turn the check off.
+*/
+void SPISlaveClass::setTimeout(uint16_t ms, bool onCSRelease)
+{
+    timeoutMs = ms;
+    timeoutOnCS = onCSRelease;
+    spi_slave_set_frame_timer(ms != 0);
+}
+
+/*
+    Reason of the last abort, SPI_SLAVE_OK if there was none. Reading
+    clears it.
+*/
+uint8_t SPISlaveClass::lastError(void)
+{
+    uint8_t e = error;
+    error = SPI_SLAVE_OK;
+    return (e);
+}
+
+/*
+    Bytes received by the frame that was last aborted.
+*/
+uint16_t SPISlaveClass::partialLength(void)
+{
+    return (partial);
+}
+
+#if SPI_SLAVE_STATS
+/*
+    Snapshot of the rolling link statistics, see utility/spi_slave_stats.h.
+*/
+void SPISlaveClass::readStats(spi_slave_stats_t &stats)
+{
+    spi_slave_stats_read(&stats);
+}
+
+void SPISlaveClass::clearStats(void)
+{
+    spi_slave_stats_clear();
 }
+#endif
 
 int SPISlaveClass::getCS(uint8_t pin)
 {
+    if ((pin == csPin) && (pin != 0))
+    {
+        return ((*csIn & csMask) ? HIGH : LOW);
+    }
+
     uint8_t bit = digitalPinToBitMask(pin);
     uint8_t port = digitalPinToPort(pin);
 
@@ -199,6 +449,56 @@ int SPISlaveClass::getCS(uint8_t pin)
     return LOW;
 }
 
+/*
+    Resolve the CS pin to its input register once, begin() does this for
+    the module's STE pin. pin 0 means no CS (3 wire), csActive() is then
+    always true. A release latch or handler moves along to the new pin.
+*/
+void SPISlaveClass::setCSPin(uint8_t pin, uint8_t activeLevel)
+{
+    uint8_t port = (pin != 0) ? digitalPinToPort(pin) : NOT_A_PORT;
+
+    if (csPin != 0)
+    {
+        ::detachInterrupt(csPin);
+    }
+    csEdge = false;
+    if (port == NOT_A_PORT)
+    {
+        csPin = 0;
+        csMask = 0;
+        csActiveBits = 0;
+        csIn = &csNone;
+        return;
+    }
+    csPin = pin;
+    csMask = digitalPinToBitMask(pin);
+    csActiveBits = (activeLevel == HIGH) ? csMask : 0;
+    csIn = portInputRegister(port);
+    attachCSInterrupt();
+}
+
+/*
+    CS asserted - a single masked read of the cached port register.
+*/
+bool SPISlaveClass::csActive(void)
+{
+    return ((*csIn & csMask) == csActiveBits);
+}
+
+/*
+    CS went inactive since the last call. Needs latchCSRelease(true).
+*/
+bool SPISlaveClass::csReleased(void)
+{
+    if (csEdge)
+    {
+        csEdge = false;
+        return (true);
+    }
+    return (false);
+}
+
 size_t SPISlaveClass::bytes_to_transmit(void)
 {
     return (spi_bytes_to_transmit());
@@ -0,0 +1,173 @@
+/*
+    SPI_Slave_Multi.cpp - several logical SPI slaves on one module
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+*/
+
+#include <Energia.h>
+
+#include "SPI_Slave_Multi.h"
+
+SPISlaveMultiClass::device_t SPISlaveMultiClass::devices[SPI_MULTI_DEVICES];
+volatile int8_t SPISlaveMultiClass::current = -1;
+
+void SPISlaveMultiClass::onCS0(void)
+{
+    onCS(0);
+}
+
+void SPISlaveMultiClass::onCS1(void)
+{
+    onCS(1);
+}
+
+void SPISlaveMultiClass::onCS2(void)
+{
+    onCS(2);
+}
+
+void SPISlaveMultiClass::onCS3(void)
+{
+    onCS(3);
+}
+
+bool SPISlaveMultiClass::selected(uint8_t n)
+{
+    return ((*devices[n].csIn & devices[n].csMask) == devices[n].csActiveBits);
+}
+
+/*
+    Arm the port interrupt of device n for its assert or release edge.
+*/
+void SPISlaveMultiClass::watch(uint8_t n, bool release)
+{
+    static void (*const handlers[SPI_MULTI_DEVICES])(void) = { onCS0, onCS1, onCS2, onCS3 };
+    bool high = (devices[n].csActiveBits != 0);
+
+    ::attachInterrupt(devices[n].csPin, handlers[n], (high != release) ? RISING : FALLING);
+}
+
+/*
+    Port interrupt of device n. On assert the transfer is armed on the
+    device's buffers, on release the frame is closed; trace and statistics
+    see a completed frame, not an abort. The pin level is checked after
+    each edge change so a short CS pulse is not lost.
+*/
+void SPISlaveMultiClass::onCS(uint8_t n)
+{
+    if (current == (int8_t)n)
+    {
+        if (selected(n))
+        {
+            return;
+        }
+        devices[n].received = spi_slave_close();
+        devices[n].ready = true;
+        current = -1;
+        watch(n, false);
+        return;
+    }
+    if ((current >= 0) || !selected(n))
+    {
+        return;  /* another device is selected, or a glitch */
+    }
+    current = n;
+    spi_slave_transfer(devices[n].rxbuf, devices[n].txbuf, devices[n].size);
+    watch(n, true);
+    if (!selected(n))
+    {
+        onCS(n);  /* released while arming */
+    }
+}
+
+/*
+    Add logical device number device with its CS pin and buffers. rxbuf
+    and txbuf may be the same buffer (a register map read and written by
+    the master). Returns false if the number or pin is invalid.
+*/
+bool SPISlaveMultiClass::attach(uint8_t device, uint8_t csPin, uint8_t *rxbuf, uint8_t *txbuf, uint16_t size, uint8_t activeLevel)
+{
+    uint8_t port;
+
+    if (device >= SPI_MULTI_DEVICES)
+    {
+        return (false);
+    }
+    port = digitalPinToPort(csPin);
+    if (port == NOT_A_PORT)
+    {
+        return (false);
+    }
+    detach(device);
+    devices[device].csPin = csPin;
+    devices[device].csMask = digitalPinToBitMask(csPin);
+    devices[device].csActiveBits = (activeLevel == HIGH) ? devices[device].csMask : 0;
+    devices[device].rxbuf = rxbuf;
+    devices[device].txbuf = txbuf;
+    devices[device].size = size;
+    devices[device].received = 0;
+    devices[device].ready = false;
+    pinMode(csPin, INPUT);
+    devices[device].csIn = portInputRegister(port);
+    watch(device, false);
+    return (true);
+}
+
+void SPISlaveMultiClass::detach(uint8_t device)
+{
+    if ((device >= SPI_MULTI_DEVICES) || (devices[device].csIn == 0))
+    {
+        return;
+    }
+    ::detachInterrupt(devices[device].csPin);
+    devices[device].csIn = 0;
+    if (current == (int8_t)device)
+    {
+        spi_slave_abort();
+        current = -1;
+    }
+}
+
+void SPISlaveMultiClass::end(void)
+{
+    uint8_t i;
+    for (i = 0; i < SPI_MULTI_DEVICES; i++)
+    {
+        detach(i);
+    }
+}
+
+/*
+    Device currently selected by the master, -1 if none.
+*/
+int8_t SPISlaveMultiClass::active(void)
+{
+    return (current);
+}
+
+/*
+    A frame for device has been closed since the last received() call.
+*/
+bool SPISlaveMultiClass::available(uint8_t device)
+{
+    return ((device < SPI_MULTI_DEVICES) && devices[device].ready);
+}
+
+/*
+    Bytes clocked in the last frame of device; clears available().
+*/
+uint16_t SPISlaveMultiClass::received(uint8_t device)
+{
+    if (device >= SPI_MULTI_DEVICES)
+    {
+        return (0);
+    }
+    devices[device].ready = false;
+    return (devices[device].received);
+}
+
+SPISlaveMultiClass SPISlaveMulti;
@@ -0,0 +1,69 @@
+/*
+    SPI_Slave_Multi.h - several logical SPI slaves on one module
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+    The module runs in 3 wire mode; each logical device has its own CS
+    input, watched by a port interrupt, and its own RX/TX buffers. When a
+    CS is asserted the transfer is armed on that device's buffers (DMA
+    where available), when it is released the frame is closed and the
+    number of bytes clocked is kept for the application.
+
+    The master has to leave the port interrupt latency (a few us) between
+    CS assert and the first clock edge. CS pins must be interrupt capable.
+
+*/
+
+#ifndef _SPISLAVE_MULTI_H_INCLUDED
+#define _SPISLAVE_MULTI_H_INCLUDED
+
+#include <Energia.h>
+#include <inttypes.h>
+#include "SPI_Slave.h"
+
+#define SPI_MULTI_DEVICES 4
+
+class SPISlaveMultiClass
+{
+  private:
+    typedef struct
+    {
+        volatile uint8_t *csIn;    /* PxIN of the CS pin, 0 if unused */
+        uint8_t csPin;
+        uint8_t csMask;
+        uint8_t csActiveBits;      /* csMask if CS is active high */
+        uint8_t *rxbuf;
+        uint8_t *txbuf;
+        uint16_t size;
+        volatile uint16_t received;
+        volatile bool ready;
+    } device_t;
+
+    static device_t devices[SPI_MULTI_DEVICES];
+    static volatile int8_t current;
+
+    static bool selected(uint8_t n);
+    static void watch(uint8_t n, bool release);
+    static void onCS(uint8_t n);
+    static void onCS0(void);
+    static void onCS1(void);
+    static void onCS2(void);
+    static void onCS3(void);
+
+  public:
+    /* the module has to be started with SPISlave.begin() in MODE_3WIRE */
+    static bool attach(uint8_t device, uint8_t csPin, uint8_t *rxbuf, uint8_t *txbuf, uint16_t size, uint8_t activeLevel = LOW);
+    static void detach(uint8_t device);
+    static void end(void);
+
+    static int8_t active(void);
+    static bool available(uint8_t device);
+    static uint16_t received(uint8_t device);
+};
+
+extern SPISlaveMultiClass SPISlaveMulti;
+
+#endif
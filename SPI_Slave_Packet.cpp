@@ -0,0 +1,327 @@
+/*
+    SPI_Slave_Packet.cpp - framed packet layer on top of the SPI Slave library
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+*/
+
+#include <Energia.h>
+
+#include "SPI_Slave_Packet.h"
+
+uint8_t *SPISlavePacketClass::pool = 0;
+uint8_t SPISlavePacketClass::slots = 0;
+uint8_t SPISlavePacketClass::maxPayload = 0;
+volatile uint8_t SPISlavePacketClass::head = 0;
+volatile uint8_t SPISlavePacketClass::tail = 0;
+volatile uint8_t SPISlavePacketClass::txPending = 0;
+volatile uint8_t SPISlavePacketClass::txInFlight = 0;
+uint8_t SPISlavePacketClass::txActive = 0;
+uint8_t SPISlavePacketClass::txLength = 0;
+uint8_t SPISlavePacketClass::txSequence = 0;
+uint8_t SPISlavePacketClass::rxSequence = 0;
+uint8_t SPISlavePacketClass::rxSynced = 0;
+volatile uint8_t SPISlavePacketClass::resync = 0;
+uint8_t SPISlavePacketClass::syncRun = 0;
+bool SPISlavePacketClass::hasCS = false;
+volatile uint16_t SPISlavePacketClass::crcErrors = 0;
+volatile uint16_t SPISlavePacketClass::lengthErrors = 0;
+volatile uint16_t SPISlavePacketClass::sequenceErrors = 0;
+volatile uint16_t SPISlavePacketClass::overruns = 0;
+
+/* Slots 0 .. slots-1 receive, slots and slots+1 are the two TX frames. */
+uint8_t *SPISlavePacketClass::slot(uint8_t index)
+{
+    return (pool + (uint16_t)index * (maxPayload + SPI_PACKET_OVERHEAD));
+}
+
+uint16_t SPISlavePacketClass::crc16(const uint8_t *data, uint16_t len)
+{
+    uint16_t crc = 0xFFFF;
+    while (len--)
+    {
+        crc = (crc >> 8) | (crc << 8);
+        crc ^= *data++;
+        crc ^= (crc & 0xFF) >> 4;
+        crc ^= crc << 12;
+        crc ^= (crc & 0xFF) << 5;
+    }
+    return (crc);
+}
+
+/*
+    Header hook - interrupt context, called after the length byte. Returns
+    the number of bytes still to receive: the longer of the two payloads
+    plus sequence and CRC. Marker bytes and bytes seen while hunting for
+    the marker end the transfer at once.
+*/
+uint16_t SPISlavePacketClass::onHeader(uint8_t *header)
+{
+    uint8_t len = header[0];
+
+    if ((len == SPI_PACKET_SYNC) || resync)
+    {
+        return (0);
+    }
+    if (len > maxPayload)
+    {
+        lengthErrors++;
+        return (0);
+    }
+    if (len < txLength)
+    {
+        len = txLength;    /* the response is clocked out in full */
+    }
+    return (len + SPI_PACKET_OVERHEAD - 1);
+}
+
+/*
+    Done hook - interrupt context. Validate the frame, queue it and arm the
+    next slot.
+*/
+void SPISlavePacketClass::onDone(uint16_t received)
+{
+    uint8_t *frame = slot(head);
+    uint8_t len = frame[0];
+    uint8_t size = (len > txLength) ? len : txLength;
+    uint8_t next;
+
+    if (resync)
+    {
+        /* hunting: marker bytes come one per transfer */
+        if ((received == 1) && (len == SPI_PACKET_SYNC))
+        {
+            if (++syncRun >= SPI_PACKET_SYNC_RUN)
+            {
+                resync = 0;
+            }
+        }
+        else
+        {
+            syncRun = 0;
+        }
+        arm();
+        return;
+    }
+    if (txInFlight && (received >= (uint16_t)txLength + SPI_PACKET_OVERHEAD))
+    {
+        txInFlight = 0;    /* the master has the whole response */
+    }
+    if ((received == 1) && (len == SPI_PACKET_SYNC))
+    {
+        arm();    /* rest of a marker, not a frame */
+        return;
+    }
+    if ((len > maxPayload) || (received != (uint16_t)size + SPI_PACKET_OVERHEAD))
+    {
+        if (len <= maxPayload)
+        {
+            lengthErrors++;    /* a too long length was counted in onHeader() */
+        }
+        lost();
+        return;
+    }
+    if (crc16(frame, len + SPI_PACKET_HEADER) != (((uint16_t)frame[len + 2] << 8) | frame[len + 3]))
+    {
+        crcErrors++;
+        lost();
+        return;
+    }
+    if (len != 0)    /* empty frames only poll for a response */
+    {
+        if (rxSynced && (frame[1] != (uint8_t)(rxSequence + 1)))
+        {
+            sequenceErrors++;
+        }
+        rxSequence = frame[1];
+        rxSynced = 1;
+
+        next = head + 1;
+        if (next >= slots)
+        {
+            next = 0;
+        }
+        if (next != tail)
+        {
+            head = next;
+            SPI_STATS_QUEUE(available());
+        }
+        else
+        {
+            overruns++;    /* queue full, slot is reused */
+        }
+    }
+    arm();
+}
+
+/*
+    Framing lost - the master may still be clocking the bad frame, so no
+    frame is armed now. With CS the release re-arms, without CS probes
+    hunt for the resync marker. The sequence check starts over.
+*/
+void SPISlavePacketClass::lost(void)
+{
+    resync = 1;
+    syncRun = 0;
+    rxSynced = 0;
+    if (!hasCS)
+    {
+        arm();
+    }
+}
+
+/*
+    CS port interrupt - frame boundary. Re-arms after a lost frame; a frame
+    the master cut short is a length error, its response is sent again.
+*/
+void SPISlavePacketClass::onRelease(void)
+{
+    if (!resync)
+    {
+        if (spi_data_done() || (spi_bytes_received() == 0))
+        {
+            return;    /* the next frame is armed and not started */
+        }
+        spi_slave_close();
+        lengthErrors++;
+        rxSynced = 0;
+    }
+    resync = 0;
+    arm();
+}
+
+/*
+    Arm the next frame: receive into the head slot, send the response in
+    flight or the pending one if there is one, an empty frame otherwise.
+    While hunting for the marker only a probe is armed, answered with 0xFF.
+*/
+void SPISlavePacketClass::arm(void)
+{
+    uint8_t *tx;
+    uint16_t crc;
+
+    if (resync)
+    {
+        spi_slave_probe(slot(head), maxPayload + SPI_PACKET_OVERHEAD);
+        return;
+    }
+    if (!txInFlight && txPending)
+    {
+        txActive ^= 1;
+        txPending = 0;
+        txInFlight = 1;
+    }
+    tx = slot(slots + txActive);
+    if (!txInFlight)
+    {
+        tx[0] = 0;
+        tx[1] = txSequence - 1;   /* empty frames do not advance the sequence */
+        crc = crc16(tx, SPI_PACKET_HEADER);
+        tx[2] = crc >> 8;
+        tx[3] = crc & 0xFF;
+    }
+    txLength = tx[0];
+    SPISlave.transfer(slot(head), tx, maxPayload + SPI_PACKET_OVERHEAD);
+}
+
+void SPISlavePacketClass::begin(uint8_t *buffer, uint8_t count, uint8_t payload)
+{
+    pool = buffer;
+    slots = count;
+    maxPayload = (payload > SPI_PACKET_MAX_PAYLOAD) ? SPI_PACKET_MAX_PAYLOAD : payload;
+    head = 0;
+    tail = 0;
+    txPending = 0;
+    txInFlight = 0;
+    txActive = 0;
+    rxSynced = 0;
+    resync = 0;
+    crcErrors = 0;
+    lengthErrors = 0;
+    sequenceErrors = 0;
+    overruns = 0;
+
+    spi_slave_set_header_hook(1, onHeader);
+    spi_slave_set_done_hook(onDone);
+    hasCS = SPISlave.attachCSRelease(onRelease);
+    arm();
+}
+
+void SPISlavePacketClass::end(void)
+{
+    SPISlave.attachCSRelease(0);
+    spi_slave_set_done_hook(0);
+    spi_slave_set_header_hook(0, 0);
+}
+
+/*
+    Number of complete packets waiting in the queue.
+*/
+uint8_t SPISlavePacketClass::available(void)
+{
+    uint8_t h = head;
+    return ((h >= tail) ? (h - tail) : (h + slots - tail));
+}
+
+uint8_t SPISlavePacketClass::length(void)
+{
+    return (slot(tail)[0]);
+}
+
+uint8_t SPISlavePacketClass::sequence(void)
+{
+    return (slot(tail)[1]);
+}
+
+/*
+    Payload of the oldest queued packet, valid until release().
+*/
+uint8_t *SPISlavePacketClass::payload(void)
+{
+    return (slot(tail) + SPI_PACKET_HEADER);
+}
+
+void SPISlavePacketClass::release(void)
+{
+    uint8_t next;
+    if (available() == 0)
+    {
+        return;
+    }
+    next = tail + 1;
+    tail = (next >= slots) ? 0 : next;
+}
+
+/*
+    Queue a response; it is sent in the frame after the current one, or
+    after the response in flight has been clocked out. Returns false while
+    a previous response is still pending.
+*/
+bool SPISlavePacketClass::write(const uint8_t *data, uint8_t len)
+{
+    uint8_t *tx;
+    uint16_t crc;
+    uint8_t i;
+
+    if (txPending || (len > maxPayload))
+    {
+        return (false);
+    }
+    tx = slot(slots + (txActive ^ 1));
+    tx[0] = len;
+    tx[1] = txSequence++;
+    for (i = 0; i < len; i++)
+    {
+        tx[SPI_PACKET_HEADER + i] = data[i];
+    }
+    crc = crc16(tx, len + SPI_PACKET_HEADER);
+    tx[len + 2] = crc >> 8;
+    tx[len + 3] = crc & 0xFF;
+    txPending = 1;
+    return (true);
+}
+
+SPISlavePacketClass SPISlavePacket;
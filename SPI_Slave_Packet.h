@@ -0,0 +1,104 @@
+/*
+    SPI_Slave_Packet.h - framed packet layer on top of the SPI Slave library
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+    Frame format (both directions):
+
+        byte 0          payload length L (0 .. maxPayload)
+        byte 1          sequence number, incremented per frame
+        byte 2..L+1     payload
+        byte L+2, L+3   CRC-16/CCITT (poly 0x1021, init 0xFFFF) over bytes 0..L+1, MSB first
+
+    Both sides send a frame in the same transfer. The master reads the
+    slave's length byte R while it sends its own and clocks max(L, R) + 4
+    bytes, padding after its CRC; the slave parses L in interrupt context
+    and cuts its receive to the same length. So a frame only takes as long
+    on the bus as the longer payload, and a response is never truncated by
+    a shorter request. Complete frames with a valid CRC are queued for the
+    application. Frames with L = 0 are polls: they carry no data, are not
+    queued and do not advance the sequence number. The slave answers every
+    frame with its pending response or with such an empty frame; a
+    response stays pending until a transfer clocked it out completely, one
+    cut short sends it again with the same sequence number.
+
+    Resync: a length or CRC error means the framing is lost, the slave
+    does not arm a frame in the middle of the master's one. With a CS pin
+    it waits for the CS release. Without CS it answers 0xFF and hunts for
+    the resync marker: SPI_PACKET_SYNC_RUN bytes of SPI_PACKET_SYNC, each
+    clocked as a transfer of its own with the usual frame gap after it.
+    Marker bytes are ignored while in sync, so the master may send the
+    marker whenever it reads 0xFF for the slave's length byte.
+
+*/
+
+#ifndef _SPISLAVE_PACKET_H_INCLUDED
+#define _SPISLAVE_PACKET_H_INCLUDED
+
+#include <Energia.h>
+#include <inttypes.h>
+#include "SPI_Slave.h"
+
+#define SPI_PACKET_HEADER   2     /* length, sequence */
+#define SPI_PACKET_OVERHEAD 4     /* header + CRC */
+#define SPI_PACKET_SYNC     0xFF  /* resync marker byte, never a valid length */
+#define SPI_PACKET_SYNC_RUN 4     /* marker bytes in a row that end a resync */
+#define SPI_PACKET_MAX_PAYLOAD 254
+
+/* Size of the pool to pass to begin(): RX slots plus two TX frames. */
+#define SPI_PACKET_POOL_SIZE(slots, maxPayload) (((slots) + 2) * ((maxPayload) + SPI_PACKET_OVERHEAD))
+
+class SPISlavePacketClass
+{
+  private:
+    static uint8_t *pool;
+    static uint8_t slots;
+    static uint8_t maxPayload;
+    static volatile uint8_t head;     /* slot being received */
+    static volatile uint8_t tail;     /* oldest queued packet */
+    static volatile uint8_t txPending;
+    static volatile uint8_t txInFlight;  /* the armed frame carries a response not yet clocked out */
+    static uint8_t txActive;
+    static uint8_t txLength;             /* length byte of the armed TX frame */
+    static uint8_t txSequence;
+    static uint8_t rxSequence;
+    static uint8_t rxSynced;
+    static volatile uint8_t resync;      /* framing lost, see above */
+    static uint8_t syncRun;
+    static bool hasCS;
+
+    static uint8_t *slot(uint8_t index);
+    static uint16_t onHeader(uint8_t *header);
+    static void onDone(uint16_t received);
+    static void onRelease(void);
+    static void lost(void);
+    static void arm(void);
+
+  public:
+    static volatile uint16_t crcErrors;
+    static volatile uint16_t lengthErrors;
+    static volatile uint16_t sequenceErrors;
+    static volatile uint16_t overruns;
+
+    /* pool must hold SPI_PACKET_POOL_SIZE(slots, maxPayload) bytes, queue capacity is slots - 1,
+       maxPayload at most SPI_PACKET_MAX_PAYLOAD */
+    static void begin(uint8_t *pool, uint8_t slots, uint8_t maxPayload);
+    static void end(void);
+
+    static uint8_t available(void);
+    static uint8_t length(void);
+    static uint8_t sequence(void);
+    static uint8_t *payload(void);
+    static void release(void);
+
+    static bool write(const uint8_t *payload, uint8_t len);
+
+    static uint16_t crc16(const uint8_t *data, uint16_t len);
+};
+
+extern SPISlavePacketClass SPISlavePacket;
+
+#endif
@@ -0,0 +1,192 @@
+/*
+    SPI_Slave_Priority.cpp - urgent and bulk response queues for the SPI Slave library
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+*/
+
+#include <Energia.h>
+
+#include "SPI_Slave_Priority.h"
+
+uint8_t *SPISlavePriorityClass::frames[2][SPI_PRIORITY_DEPTH];
+uint16_t SPISlavePriorityClass::lengths[2][SPI_PRIORITY_DEPTH];
+volatile uint8_t SPISlavePriorityClass::head[2] = { 0, 0 };
+volatile uint8_t SPISlavePriorityClass::tail[2] = { 0, 0 };
+volatile uint8_t SPISlavePriorityClass::owner = SPI_OWNER_NONE;
+uint8_t SPISlavePriorityClass::empty[SPI_PRIORITY_HEADER] = { 0, 0 };
+volatile uint16_t SPISlavePriorityClass::preempted = 0;
+
+uint8_t SPISlavePriorityClass::queued(uint8_t queue)
+{
+    uint8_t h = head[queue];
+    uint8_t t = tail[queue];
+    return ((h >= t) ? (h - t) : (h + SPI_PRIORITY_DEPTH - t));
+}
+
+/*
+    Status hook - called when a response is armed, its byte is the first
+    one the master reads.
+*/
+uint8_t SPISlavePriorityClass::status(void)
+{
+    uint8_t s = owner;
+
+    if (queued(SPI_PRIORITY_URGENT) > ((owner == SPI_OWNER_URGENT) ? 1 : 0))
+    {
+        s |= SPI_STATUS_URGENT_PENDING;
+    }
+    if (queued(SPI_PRIORITY_BULK) > ((owner == SPI_OWNER_BULK) ? 1 : 0))
+    {
+        s |= SPI_STATUS_BULK_PENDING;
+    }
+    return (s);
+}
+
+/*
+    Done hook - interrupt context. The armed response was clocked out
+    completely, retire it and arm the next one.
+*/
+void SPISlavePriorityClass::onDone(uint16_t received)
+{
+    uint8_t queue;
+    uint8_t next;
+
+    (void)received;
+    if (owner != SPI_OWNER_NONE)
+    {
+        queue = owner - 1;
+        next = tail[queue] + 1;
+        tail[queue] = (next >= SPI_PRIORITY_DEPTH) ? 0 : next;
+    }
+    arm();
+}
+
+/*
+    CS port interrupt - frame boundary. A response cut short stays queued,
+    the highest priority one is armed for the next frame.
+*/
+void SPISlavePriorityClass::onRelease(void)
+{
+    if (spi_data_done() || (spi_bytes_received() == 0))
+    {
+        return;    /* the next response is armed and not started */
+    }
+    spi_slave_close();
+    arm();
+}
+
+/*
+    Arm the oldest urgent response, else the oldest bulk one, else an
+    empty frame. Interrupt context or interrupts off.
+*/
+void SPISlavePriorityClass::arm(void)
+{
+    uint8_t queue;
+    uint8_t t;
+
+    for (queue = SPI_PRIORITY_URGENT; queue <= SPI_PRIORITY_BULK; queue++)
+    {
+        t = tail[queue];
+        if (head[queue] != t)
+        {
+            owner = queue + 1;
+            spi_slave_transfer(0, frames[queue][t], 1 + SPI_PRIORITY_HEADER + lengths[queue][t]);
+            return;
+        }
+    }
+    owner = SPI_OWNER_NONE;
+    spi_slave_transfer(0, empty, 1 + SPI_PRIORITY_HEADER);
+}
+
+void SPISlavePriorityClass::begin(void)
+{
+    head[SPI_PRIORITY_URGENT] = 0;
+    tail[SPI_PRIORITY_URGENT] = 0;
+    head[SPI_PRIORITY_BULK] = 0;
+    tail[SPI_PRIORITY_BULK] = 0;
+    preempted = 0;
+
+    spi_slave_set_status_hook(status);
+    spi_slave_set_done_hook(onDone);
+    SPISlave.attachCSRelease(onRelease);
+    arm();
+}
+
+void SPISlavePriorityClass::end(void)
+{
+    SPISlave.attachCSRelease(0);
+    spi_slave_set_done_hook(0);
+    spi_slave_set_status_hook(0);
+    spi_slave_abort();
+    owner = SPI_OWNER_NONE;
+}
+
+/*
+    Queue a response. If it outranks the armed one and the master has not
+    started on that yet, it is armed in its place right away; otherwise
+    it goes out at the next frame boundary. Returns false if the queue is
+    full.
+*/
+bool SPISlavePriorityClass::post(uint8_t queue, uint8_t *frame, uint16_t length)
+{
+    uint8_t h;
+    uint8_t next;
+    uint16_t sr;
+
+    if (queue > SPI_PRIORITY_BULK)
+    {
+        return (false);
+    }
+    h = head[queue];
+    next = h + 1;
+    if (next >= SPI_PRIORITY_DEPTH)
+    {
+        next = 0;
+    }
+    if (next == tail[queue])
+    {
+        return (false);
+    }
+    frame[0] = length & 0xFF;
+    frame[1] = length >> 8;
+    frames[queue][h] = frame;
+    lengths[queue][h] = length;
+
+    sr = __get_SR_register();
+    __disable_interrupt();
+    head[queue] = next;
+    if (((owner == SPI_OWNER_NONE) || (owner > queue + 1))
+            && (spi_bytes_received() == 0) && !SPISlave.csActive())
+    {
+        if (owner != SPI_OWNER_NONE)
+        {
+            preempted++;
+        }
+        arm();
+    }
+    __bis_SR_register(sr & GIE);
+    return (true);
+}
+
+/*
+    Responses of queue not yet clocked out completely, the armed one
+    included.
+*/
+uint8_t SPISlavePriorityClass::pending(uint8_t queue)
+{
+    return ((queue > SPI_PRIORITY_BULK) ? 0 : queued(queue));
+}
+
+/*
+    Owner of the armed response, SPI_OWNER_xxx.
+*/
+uint8_t SPISlavePriorityClass::active(void)
+{
+    return (owner);
+}
+
+SPISlavePriorityClass SPISlavePriority;
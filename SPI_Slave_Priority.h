@@ -0,0 +1,90 @@
+/*
+    SPI_Slave_Priority.h - urgent and bulk response queues for the SPI Slave library
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+    Every frame the master clocks is answered with one response:
+
+        byte 0          status: owner of the response (SPI_OWNER_xxx)
+                        plus the SPI_STATUS_xxx_PENDING flags
+        byte 1, 2       payload length L, LSB first
+        byte 3..L+2     payload
+
+    Responses are queued as urgent or bulk. At every frame boundary the
+    oldest urgent response is armed before any bulk one, and an urgent
+    response posted while a bulk one is armed but not yet started takes
+    its place at once (with a CS pin, which tells that the bus is idle).
+    So control latency is bounded by the bulk frame already on the bus,
+    not by the bulk frames queued behind it. With no response queued the
+    master reads an empty frame owned by SPI_OWNER_NONE.
+
+    A response is retired when all of its bytes were clocked; a frame cut
+    short by the CS release sends the same response again. The buffers are
+    not copied: post() takes a frame with SPI_PRIORITY_HEADER spare bytes
+    in front of the payload, it has to stay untouched until pending() no
+    longer counts it. The received bytes are dropped.
+
+    Uses the done and status hooks and the CS release handler of
+    SPISlave; the master should wait for the ready pin or read the status
+    byte before trusting the rest of a frame.
+
+*/
+
+#ifndef _SPISLAVE_PRIORITY_H_INCLUDED
+#define _SPISLAVE_PRIORITY_H_INCLUDED
+
+#include <Energia.h>
+#include <inttypes.h>
+#include "SPI_Slave.h"
+
+#define SPI_PRIORITY_URGENT 0
+#define SPI_PRIORITY_BULK   1
+
+#define SPI_PRIORITY_HEADER 2   /* spare bytes in front of every payload: length, LSB first */
+
+#ifndef SPI_PRIORITY_DEPTH
+#define SPI_PRIORITY_DEPTH  4   /* queue entries per priority, capacity is DEPTH - 1 */
+#endif
+
+/* status byte */
+#define SPI_OWNER_NONE      0x00
+#define SPI_OWNER_URGENT    (SPI_PRIORITY_URGENT + 1)
+#define SPI_OWNER_BULK      (SPI_PRIORITY_BULK + 1)
+#define SPI_OWNER_MASK      0x03
+#define SPI_STATUS_URGENT_PENDING 0x10   /* more urgent responses queued */
+#define SPI_STATUS_BULK_PENDING   0x20   /* more bulk responses queued */
+
+class SPISlavePriorityClass
+{
+  private:
+    static uint8_t *frames[2][SPI_PRIORITY_DEPTH];
+    static uint16_t lengths[2][SPI_PRIORITY_DEPTH];
+    static volatile uint8_t head[2];    /* written by post() */
+    static volatile uint8_t tail[2];    /* written in interrupt context */
+    static volatile uint8_t owner;      /* SPI_OWNER_xxx of the armed response */
+    static uint8_t empty[SPI_PRIORITY_HEADER];
+
+    static uint8_t queued(uint8_t queue);
+    static uint8_t status(void);
+    static void onDone(uint16_t received);
+    static void onRelease(void);
+    static void arm(void);
+
+  public:
+    static volatile uint16_t preempted;
+
+    static void begin(void);
+    static void end(void);
+
+    /* frame: SPI_PRIORITY_HEADER spare bytes, then length payload bytes */
+    static bool post(uint8_t queue, uint8_t *frame, uint16_t length);
+    static uint8_t pending(uint8_t queue);
+    static uint8_t active(void);
+};
+
+extern SPISlavePriorityClass SPISlavePriority;
+
+#endif
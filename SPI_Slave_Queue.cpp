@@ -0,0 +1,154 @@
+/*
+    SPI_Slave_Queue.cpp - zero copy frame queue fed by the SPI Slave library
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+*/
+
+#include <Energia.h>
+
+#include "SPI_Slave_Queue.h"
+
+uint8_t *SPISlaveQueueClass::pool = 0;
+uint8_t SPISlaveQueueClass::slots = 0;
+uint16_t SPISlaveQueueClass::size = 0;
+uint8_t *SPISlaveQueueClass::reply = 0;
+volatile uint8_t SPISlaveQueueClass::head = 0;
+volatile uint8_t SPISlaveQueueClass::tail = 0;
+volatile uint16_t SPISlaveQueueClass::dropped = 0;
+
+uint8_t *SPISlaveQueueClass::slot(uint8_t index)
+{
+    return (pool + (uint16_t)index * (size + SPI_QUEUE_LENGTH));
+}
+
+/*
+    Interrupt context. Store the length in front of the frame and hand the
+    slot to the consumer; without a free slot the frame is dropped and the
+    slot is received again.
+*/
+void SPISlaveQueueClass::push(uint16_t received)
+{
+    uint8_t *frame = slot(head);
+    uint8_t next;
+
+    if (received == 0)
+    {
+        return;
+    }
+    frame[0] = received & 0xFF;
+    frame[1] = received >> 8;
+    next = head + 1;
+    if (next >= slots)
+    {
+        next = 0;
+    }
+    if (next != tail)
+    {
+        head = next;
+        SPI_STATS_QUEUE(available());
+    }
+    else
+    {
+        dropped++;
+    }
+}
+
+/*
+    Done hook - the slot is full.
+*/
+void SPISlaveQueueClass::onDone(uint16_t received)
+{
+    push(received);
+    arm();
+}
+
+/*
+    CS port interrupt - the frame ended before the slot was full.
+*/
+void SPISlaveQueueClass::onRelease(void)
+{
+    if (spi_data_done() || (spi_bytes_received() == 0))
+    {
+        return;    /* the next slot is armed and not started */
+    }
+    push(spi_slave_close());
+    arm();
+}
+
+/*
+    Receive the next frame into the head slot, answer with the reply
+    buffer if there is one, 0xFF otherwise.
+*/
+void SPISlaveQueueClass::arm(void)
+{
+    if (reply)
+    {
+        spi_slave_transfer(slot(head) + SPI_QUEUE_LENGTH, reply, size);
+    }
+    else
+    {
+        spi_slave_receive(slot(head) + SPI_QUEUE_LENGTH, size);
+    }
+}
+
+void SPISlaveQueueClass::begin(uint8_t *buffer, uint8_t count, uint16_t length, uint8_t *tx)
+{
+    pool = buffer;
+    slots = count;
+    size = length;
+    reply = tx;
+    head = 0;
+    tail = 0;
+    dropped = 0;
+
+    spi_slave_set_done_hook(onDone);
+    SPISlave.attachCSRelease(onRelease);
+    arm();
+}
+
+void SPISlaveQueueClass::end(void)
+{
+    SPISlave.attachCSRelease(0);
+    spi_slave_set_done_hook(0);
+    spi_slave_abort();
+}
+
+/*
+    Number of frames waiting in the queue.
+*/
+uint8_t SPISlaveQueueClass::available(void)
+{
+    uint8_t h = head;
+    return ((h >= tail) ? (h - tail) : (h + slots - tail));
+}
+
+/*
+    Oldest queued frame, valid in place until release().
+*/
+uint8_t *SPISlaveQueueClass::front(void)
+{
+    return (slot(tail) + SPI_QUEUE_LENGTH);
+}
+
+uint16_t SPISlaveQueueClass::length(void)
+{
+    uint8_t *frame = slot(tail);
+    return (frame[0] | ((uint16_t)frame[1] << 8));
+}
+
+void SPISlaveQueueClass::release(void)
+{
+    uint8_t next;
+    if (available() == 0)
+    {
+        return;
+    }
+    next = tail + 1;
+    tail = (next >= slots) ? 0 : next;
+}
+
+SPISlaveQueueClass SPISlaveQueue;
@@ -0,0 +1,65 @@
+/*
+    SPI_Slave_Queue.h - zero copy frame queue fed by the SPI Slave library
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+    Frames are received straight into the slots of a pool given to begin().
+    A frame ends when its slot is full or, with a CS pin, when CS is
+    released. The done hook queues the slot and arms the next one, so no
+    frame is copied and the bus never waits for loop(). The application
+    reads the oldest frame in place with front() / length() and hands the
+    slot back with release().
+
+    Single producer (interrupts), single consumer (loop()): head is only
+    written in interrupt context, tail only by release(). When all slots
+    are taken the newest frame is dropped and counted in dropped.
+
+*/
+
+#ifndef _SPISLAVE_QUEUE_H_INCLUDED
+#define _SPISLAVE_QUEUE_H_INCLUDED
+
+#include <Energia.h>
+#include <inttypes.h>
+#include "SPI_Slave.h"
+
+#define SPI_QUEUE_LENGTH 2   /* per slot: received length, LSB first */
+
+/* Size of the pool to pass to begin(). */
+#define SPI_QUEUE_POOL_SIZE(slots, size) ((slots) * ((size) + SPI_QUEUE_LENGTH))
+
+class SPISlaveQueueClass
+{
+  private:
+    static uint8_t *pool;
+    static uint8_t slots;
+    static uint16_t size;
+    static uint8_t *reply;
+    static volatile uint8_t head;     /* slot being received */
+    static volatile uint8_t tail;     /* oldest queued frame */
+
+    static uint8_t *slot(uint8_t index);
+    static void push(uint16_t received);
+    static void onDone(uint16_t received);
+    static void onRelease(void);
+    static void arm(void);
+
+  public:
+    static volatile uint16_t dropped;
+
+    /* pool must hold SPI_QUEUE_POOL_SIZE(slots, size) bytes, queue capacity is slots - 1 */
+    static void begin(uint8_t *pool, uint8_t slots, uint16_t size, uint8_t *reply = 0);
+    static void end(void);
+
+    static uint8_t available(void);
+    static uint8_t *front(void);
+    static uint16_t length(void);
+    static void release(void);
+};
+
+extern SPISlaveQueueClass SPISlaveQueue;
+
+#endif
@@ -0,0 +1,147 @@
+/*
+    SPI_Slave_Window.cpp - a RAM/FRAM window behind an SPI SRAM style protocol
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+*/
+
+#include <Energia.h>
+
+#include "SPI_Slave_Window.h"
+
+#define PHASE_IDLE   0   /* command ignored up to the CS release */
+#define PHASE_HEADER 1
+#define PHASE_READ   2
+#define PHASE_WRITE  3
+
+uint8_t *SPISlaveWindowClass::window = 0;
+uint16_t SPISlaveWindowClass::size = 0;
+uint8_t SPISlaveWindowClass::addressBytes = 2;
+bool SPISlaveWindowClass::writable = true;
+uint8_t SPISlaveWindowClass::command[5];
+volatile uint8_t SPISlaveWindowClass::phase = PHASE_IDLE;
+volatile uint16_t SPISlaveWindowClass::reads = 0;
+volatile uint16_t SPISlaveWindowClass::writes = 0;
+
+/*
+    Header hook - interrupt context. The opcode sizes the rest of the
+    command: the address, plus the dummy byte of FAST_READ.
+*/
+uint16_t SPISlaveWindowClass::onHeader(uint8_t *header)
+{
+    switch (header[0])
+    {
+        case SPI_WINDOW_READ:
+        case SPI_WINDOW_WRITE:
+            return (addressBytes);
+        case SPI_WINDOW_FAST_READ:
+            return (addressBytes + 1);
+        default:
+            return (0);
+    }
+}
+
+/*
+    Done hook - interrupt context. After the command the data phase is
+    armed at the address, at the end of the window it restarts at the
+    window start.
+*/
+void SPISlaveWindowClass::onDone(uint16_t received)
+{
+    uint32_t address = 0;
+    uint16_t offset;
+    uint8_t i;
+
+    switch (phase)
+    {
+        case PHASE_HEADER:
+            phase = PHASE_IDLE;
+            if ((received < (uint16_t)(1 + addressBytes)) || ((command[0] == SPI_WINDOW_WRITE) && !writable))
+            {
+                return;
+            }
+            for (i = 1; i <= addressBytes; i++)
+            {
+                address = (address << 8) | command[i];
+            }
+            offset = (uint16_t)(address % size);
+            spi_slave_set_header_hook(0, 0);
+            if (command[0] == SPI_WINDOW_WRITE)
+            {
+                phase = PHASE_WRITE;
+                writes++;
+                spi_slave_receive(window + offset, size - offset);
+            }
+            else
+            {
+                phase = PHASE_READ;
+                reads++;
+                spi_slave_transfer(0, window + offset, size - offset);
+            }
+            break;
+        case PHASE_READ:
+            spi_slave_transfer(0, window, size);
+            break;
+        case PHASE_WRITE:
+            spi_slave_receive(window, size);
+            break;
+        default:
+            break;
+    }
+}
+
+/*
+    CS port interrupt - the command is over, wait for the next opcode.
+    A data phase the done hook armed and the master did not start is
+    replaced without a close.
+*/
+void SPISlaveWindowClass::onRelease(void)
+{
+    if (!spi_data_done() && (spi_bytes_received() != 0))
+    {
+        spi_slave_close();
+    }
+    else if (phase == PHASE_HEADER)
+    {
+        return;    /* the opcode is armed and not started */
+    }
+    arm();
+}
+
+void SPISlaveWindowClass::arm(void)
+{
+    phase = PHASE_HEADER;
+    spi_slave_set_header_hook(1, onHeader);
+    spi_slave_receive(command, 1 + addressBytes + 1);
+}
+
+void SPISlaveWindowClass::begin(uint8_t *buffer, uint16_t length, uint8_t address, bool write)
+{
+    window = buffer;
+    size = length;
+    addressBytes = (address == 3) ? 3 : 2;
+    writable = write;
+    reads = 0;
+    writes = 0;
+
+    spi_slave_set_done_hook(onDone);
+    SPISlave.attachCSRelease(onRelease);
+    arm();
+}
+
+void SPISlaveWindowClass::end(void)
+{
+    SPISlave.attachCSRelease(0);
+    spi_slave_abort();
+    phase = PHASE_IDLE;
+    spi_slave_set_done_hook(0);
+    spi_slave_set_header_hook(0, 0);
+}
+
+/*
+    Pre-Initialize a SPI Slave Window instance
+*/
+SPISlaveWindowClass SPISlaveWindow;
@@ -0,0 +1,68 @@
+/*
+    SPI_Slave_Window.h - a RAM/FRAM window behind an SPI SRAM style protocol
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+    Frame format, one command per CS frame:
+
+        0x03 READ       address, data out ...
+        0x0B FAST_READ  address, dummy byte, data out ...
+        0x02 WRITE      address, data in ...
+
+    The address is 2 or 3 bytes, MSB first, taken modulo the window size.
+    The data phase runs by DMA where available, the address increments
+    with every byte and wraps from the end of the window to its start.
+    Unknown opcodes, and WRITE on a read-only window, are ignored up to
+    the CS release.
+
+    The opcode is sized by the header hook, the data phase is armed from
+    the done hook once the address is in. The master has to leave that
+    interrupt latency (a few us) after the address, or after the dummy
+    byte of FAST_READ, before it clocks data; the same at a wrap. CS must
+    be an interrupt capable pin (4 wire mode or setCSPin()), its release
+    ends the command, so leave the port interrupt latency before the next
+    CS assert.
+
+*/
+
+#ifndef _SPISLAVE_WINDOW_H_INCLUDED
+#define _SPISLAVE_WINDOW_H_INCLUDED
+
+#include <Energia.h>
+#include <inttypes.h>
+#include "SPI_Slave.h"
+
+#define SPI_WINDOW_WRITE     0x02
+#define SPI_WINDOW_READ      0x03
+#define SPI_WINDOW_FAST_READ 0x0B
+
+class SPISlaveWindowClass
+{
+  private:
+    static uint8_t *window;
+    static uint16_t size;
+    static uint8_t addressBytes;
+    static bool writable;
+    static uint8_t command[5];     /* opcode, address, dummy */
+    static volatile uint8_t phase;
+
+    static uint16_t onHeader(uint8_t *header);
+    static void onDone(uint16_t received);
+    static void onRelease(void);
+    static void arm(void);
+
+  public:
+    static volatile uint16_t reads;
+    static volatile uint16_t writes;
+
+    /* the module has to be started with SPISlave.begin() first */
+    static void begin(uint8_t *window, uint16_t size, uint8_t addressBytes = 2, bool writable = true);
+    static void end(void);
+};
+
+extern SPISlaveWindowClass SPISlaveWindow;
+
+#endif
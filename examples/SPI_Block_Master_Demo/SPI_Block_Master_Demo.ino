@@ -4,6 +4,8 @@
     This example contains the SPI Master code for the SPI Slave demo with sending fixed blocks of data.
     Program this code to a device which should act as master and connect the 4 wires used for SPI
     communication the the Slave *SCK, MISO, SIMO, SS (STE)
+    Connect RDY to the ready output of the slave, the master only starts a block when the slave
+    has armed the next transfer.
 
     created 19 Jan 2019
     by StefanSch
@@ -21,6 +23,8 @@ uint8_t datain[DATASIZE];
 #define SS 5
 #endif
 
+#define RDY 11 // ready output of the slave, high = armed
+
 void setup()
 {
     //Initialize serial
@@ -32,6 +36,7 @@ void setup()
     // initialize SPI Master:
     digitalWrite(SS, HIGH);
     pinMode(SS, OUTPUT);
+    pinMode(RDY, INPUT);
     SPI.begin();
     SPI.setClockDivider(10);
 
@@ -53,11 +58,12 @@ void sendData()
     }
     Serial.println(""); // new line
 
+    // wait for the slave to be ready:
+    while (digitalRead(RDY) != HIGH);
     // take the SS pin low to select the chip:
     digitalWrite(SS, LOW);
     SPI.transfer(data, DATASIZE);
     // take the SS pin high to de-select the chip:
-    delay(10);
     digitalWrite(SS, HIGH);
 
     Serial.print("=> "); // data received
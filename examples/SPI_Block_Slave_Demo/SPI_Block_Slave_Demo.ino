@@ -16,6 +16,7 @@ uint8_t txbuffer[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
 uint8_t rxbuffer[10];
 
 #define STE 8
+#define RDY 11 // ready output to the master, high = armed
 
 void setup()
 {
@@ -39,6 +40,9 @@ void setup()
     pinMode_int(3, PORT_SELECTION0);
     pinMode_int(STE, PORT_SELECTION0);
     SPISlave.begin(SPISlaveSettings(MODE_4WIRE_STE0, MSBFIRST, SPI_MODE0));
+    SPISlave.setReadyPin(RDY, HIGH);
+    // a frame the master breaks off is dropped and re-armed after 100 ms
+    SPISlave.setTimeout(100);
 }
 
 void loop()
@@ -60,3 +64,4 @@ void loop()
         }
         Serial.println("");
     }
+}
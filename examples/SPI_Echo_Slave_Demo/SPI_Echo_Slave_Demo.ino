@@ -0,0 +1,49 @@
+/*
+    SPI_Echo_Slave_Demo
+
+    This example Demos the SPI Slave loopback mode. Every byte received from the master is sent
+    back in the next byte slot, so the master receives its own data delayed by one byte.
+    Use it together with the SPI_Master_Demo to check the wiring and the maximum SCK of a link.
+
+    created 19 Oct 2026
+
+*/
+
+
+// include the SPI Slave library:
+#include <SPI_Slave.h>
+
+#define STE 8
+
+void setup()
+{
+    pinMode(RED_LED, OUTPUT);
+    digitalWrite(RED_LED, LOW);   // set the LED off
+    //Initialize serial
+    Serial.begin(115200);
+
+    Serial.println("\nEcho Slave Started");
+
+    // sync on STE
+    pinMode(STE, INPUT);
+    while (digitalRead(STE) != HIGH); // wait for High = disable -> start
+
+    // initialize SPI Slave with STE low = active:
+    SPISlave.begin(SPISlaveSettings(MODE_4WIRE_STE0, MSBFIRST, SPI_MODE0),
+                   13, /* Module */
+                   5, /* SCK */
+                   3, /* MOSI */
+                   4, /* MISO */
+                   STE, /* CS */
+                   PORT_SELECTION0 /* PIN Mode */
+                  );
+
+    // echo unmodified: handled by DMA where available, no CPU involvement
+    SPISlave.echo();
+    // echo with transform: SPISlave.echo(0x00, 1); sends back received byte + 1
+}
+
+void loop()
+{
+    digitalWrite(RED_LED, SPISlave.csActive() ? HIGH : LOW);
+}
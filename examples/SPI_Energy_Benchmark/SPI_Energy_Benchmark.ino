@@ -0,0 +1,172 @@
+/*
+    SPI_Energy_Benchmark
+
+    This example finds the lowest-energy MCLK for a slave link. Use it together with the
+    SPI_Master_Block_Demo: the slave answers every 10 byte frame with the data it received
+    and checks it. For each MCLK divider the link runs RUN_MS milliseconds, then throughput,
+    errors and the energy per byte are printed:
+
+        shift  MCLK kHz  frames/s  bytes/s  errors  nJ/byte
+
+    The energy comes from the current figures below, take them from the datasheet of the
+    device or measure them with EnergyTrace. The slave then stays at the divider with the
+    lowest energy per byte that is error free and keeps 95 % of the full speed throughput.
+    SPISlave.scaleMclk() gives the estimate of the library for comparison.
+
+    created 19 Oct 2026
+
+*/
+
+
+// include the SPI Slave library:
+#include <SPI_Slave.h>
+
+#define STE 8
+#define RDY 11 // ready output to the master, high = armed
+
+#define DATASIZE 10             // frame size of the SPI_Master_Block_Demo
+#define SCK_HZ 8000000UL        // SCK of the master
+#define RUN_MS 2000             // per operating point
+
+// device figures, e.g. MSP430FR5969 at 3 V
+#define SUPPLY_MV 3000
+#define ACTIVE_UA_PER_MHZ 100   // active mode current per MHz of MCLK
+#define STATIC_UA 20            // part of the current independent of MCLK
+
+uint8_t buffer[DATASIZE];
+volatile uint32_t frames = 0;
+volatile uint32_t errors = 0;
+
+uint8_t best = 0;
+
+// done hook, interrupt context: check the frame and send it back in the next one
+void onDone(uint16_t received)
+{
+    uint8_t i;
+
+    if (received != DATASIZE)
+    {
+        errors++;
+    }
+    else
+    {
+        for (i = 0; i < DATASIZE; i++)
+        {
+            if (buffer[i] != i)
+            {
+                errors++;
+                break;
+            }
+        }
+    }
+    frames++;
+    spi_slave_transfer(buffer, buffer, DATASIZE);
+}
+
+// run one operating point, returns the bytes per second, errors in *failed
+uint32_t run(uint8_t shift, uint32_t *failed)
+{
+    uint32_t count;
+    uint32_t bytes;
+    uint32_t mclk;
+    uint32_t microwatt;
+
+    SPISlave.setMclkShift(shift);
+    noInterrupts();
+    frames = 0;
+    errors = 0;
+    interrupts();
+    delay(RUN_MS);
+    noInterrupts();
+    count = frames;
+    *failed = errors;
+    interrupts();
+
+    bytes = (count * DATASIZE * 1000) / RUN_MS;
+    mclk = F_CPU >> shift;
+    microwatt = ((uint32_t)ACTIVE_UA_PER_MHZ * (mclk / 1000) / 1000 + STATIC_UA) * SUPPLY_MV / 1000;
+
+    Serial.print(shift);
+    Serial.print("  ");
+    Serial.print(mclk / 1000);
+    Serial.print("  ");
+    Serial.print((count * 1000) / RUN_MS);
+    Serial.print("  ");
+    Serial.print(bytes);
+    Serial.print("  ");
+    Serial.print(*failed);
+    Serial.print("  ");
+    if (bytes)
+    {
+        Serial.println((microwatt * 1000) / bytes);  // uW / (bytes/s) = uJ/byte, printed in nJ
+    }
+    else
+    {
+        Serial.println("-");
+    }
+    return (bytes);
+}
+
+void setup()
+{
+    uint32_t full;
+    uint32_t bytes;
+    uint32_t failed;
+    uint32_t energy;
+    uint32_t lowest = 0xFFFFFFFF;
+    uint8_t shift;
+
+    //Initialize serial
+    Serial.begin(115200);
+
+    Serial.println("\nEnergy Benchmark Started");
+
+    // sync on STE
+    pinMode(STE, INPUT);
+    while (digitalRead(STE) != HIGH); // wait for High = disable -> start
+
+    // initialize SPI Slave with STE low = active:
+    SPISlave.begin(SPISlaveSettings(MODE_4WIRE_STE0, MSBFIRST, SPI_MODE0),
+                   13, /* Module */
+                   5, /* SCK */
+                   3, /* MOSI */
+                   4, /* MISO */
+                   STE, /* CS */
+                   PORT_SELECTION0 /* PIN Mode */
+                  );
+    SPISlave.setReadyPin(RDY, HIGH);
+    spi_slave_set_done_hook(onDone);
+    spi_slave_transfer(buffer, buffer, DATASIZE);
+
+    Serial.println(SPISlave.usesDMA() ? "DMA" : "interrupt mode");
+    Serial.println("shift  MCLK kHz  frames/s  bytes/s  errors  nJ/byte");
+    full = run(0, &failed);
+    for (shift = 0; shift <= spi_slave_mclk_max_divider(); shift++)
+    {
+        bytes = (shift == 0) ? full : run(shift, &failed);
+        if ((failed != 0) || (bytes == 0) || (bytes < (full / 100) * 95))
+        {
+            continue;
+        }
+        energy = ((uint32_t)ACTIVE_UA_PER_MHZ * ((F_CPU >> shift) / 1000) / 1000 + STATIC_UA) * SUPPLY_MV / bytes;
+        if (energy < lowest)
+        {
+            lowest = energy;
+            best = shift;
+        }
+    }
+
+    Serial.print("best shift: ");
+    Serial.print(best);
+    Serial.print(" library estimate: ");
+    Serial.println(SPISlave.scaleMclk(SCK_HZ, (full + DATASIZE - 1) / DATASIZE));
+    SPISlave.setMclkShift(best);
+}
+
+void loop()
+{
+    uint32_t failed;
+
+    // keep reporting at the chosen operating point
+    run(best, &failed);
+}
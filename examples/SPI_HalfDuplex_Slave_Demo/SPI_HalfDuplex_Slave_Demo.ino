@@ -0,0 +1,89 @@
+/*
+    SPI_HalfDuplex_Slave_Demo
+
+    This example Demos the half-duplex 3 wire mode of the SPI Slave library: command and
+    response share one data line. Wire MOSI and MISO of the slave together to the data line
+    of the master. The master sends a 2 byte command (register address, length), pauses SCK
+    for the turnaround, releases the data line and clocks length bytes back. The slave fills
+    the response from a small register file in the turnaround callback; MISO only drives the
+    line from the turnaround to the end of the response. Frames are delimited by the byte
+    count, there is no CS in 3 wire mode.
+
+    See utility/spi_slave_timing.h (SPI_TIMING_HALF) or the SPI_Timing_Model example for the
+    pause the master has to leave at the turnaround.
+
+    created 19 Oct 2026
+
+*/
+
+
+// include the SPI Slave library:
+#include <SPI_Slave.h>
+
+#define REGISTERS 16
+#define MAX_READ 8
+
+uint8_t registers[REGISTERS];
+uint8_t command[2];
+uint8_t response[MAX_READ];
+uint16_t frames = 0;
+
+/* Turnaround: runs in interrupt context, the master waits for it */
+uint16_t onTurnaround(uint8_t *cmd)
+{
+    uint8_t addr = cmd[0] % REGISTERS;
+    uint8_t len = (cmd[1] < MAX_READ) ? cmd[1] : MAX_READ;
+    uint8_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        response[i] = registers[(addr + i) % REGISTERS];
+    }
+    return (len);
+}
+
+void setup()
+{
+    uint8_t i;
+
+    //Initialize serial
+    Serial.begin(115200);
+
+    for (i = 0; i < REGISTERS; i++)
+    {
+        registers[i] = i;
+    }
+
+    // initialize SPI Slave, one data line and no CS:
+    SPISlave.begin(SPISlaveSettings(MODE_3WIRE_HALF, MSBFIRST, SPI_MODE0),
+                   13, /* Module */
+                   5, /* SCK */
+                   3, /* MOSI, on the data line */
+                   4, /* MISO, on the data line */
+                   0, /* no CS */
+                   PORT_SELECTION0 /* PIN Mode */
+                  );
+    SPISlave.setTurnaroundCallback(onTurnaround);
+    SPISlave.halfDuplex(command, sizeof(command), response, sizeof(response));
+
+    Serial.println("\nHalf-duplex Slave Started");
+}
+
+void loop()
+{
+    if (SPISlave.transactionDone())
+    {
+        frames++;
+        // re-arm for the next command
+        SPISlave.halfDuplex(command, sizeof(command), response, sizeof(response));
+
+        Serial.print("frame ");
+        Serial.print(frames);
+        Serial.print(": read ");
+        Serial.print(command[1]);
+        Serial.print(" at ");
+        Serial.println(command[0], HEX);
+    }
+    // register 0 counts seconds
+    registers[0] = millis() / 1000;
+}
@@ -0,0 +1,95 @@
+/*
+    SPI_Master_Block_Demo
+
+    This example contains the SPI Master code for the SPI_Block_Slave_Demo. The frames are
+    clocked by DMA with SPIMasterBlock and the link throughput is printed once per second.
+    Program this code to a device which should act as master and connect the 4 wires used for SPI
+    communication the the Slave *SCK, MISO, SIMO, SS (STE)
+    Connect RDY to the ready output of the slave, the master only starts a frame when the slave
+    has armed the next transfer.
+
+    created 19 Oct 2026
+
+*/
+
+#define DATASIZE 10
+uint8_t data[DATASIZE];
+uint8_t datain[DATASIZE];
+
+// include the SPI library and the master block driver:
+#include <SPI.h>
+#include <SPI_Master_Block.h>
+
+#ifndef SS
+#define SS 5
+#endif
+
+#define RDY 11 // ready output of the slave, high = armed
+
+uint32_t frames = 0;
+uint32_t errors = 0;
+uint32_t notReady = 0;
+uint32_t lastReport = 0;
+
+void setup()
+{
+    uint16_t i;
+
+    //Initialize serial
+    Serial.begin(115200);
+
+    // initialize SPI Master:
+    SPI.begin();
+    SPI.setClockDivider(2);
+    SPIMasterBlock.begin(SS);
+    SPIMasterBlock.setReadyPin(RDY, HIGH);
+    SPIMasterBlock.setGap(5); // us CS high, covers the slave's re-arm latency
+
+    for (i = 0; i < DATASIZE; i++)
+    {
+        data[i] = i;
+    }
+
+    Serial.print("Master Started, ");
+    Serial.println(SPIMasterBlock.usesDMA() ? "DMA" : "byte transfers");
+    lastReport = millis();
+}
+
+void loop()
+{
+    uint16_t i;
+    uint32_t now;
+
+    if (!SPIMasterBlock.transfer(datain, data, DATASIZE))
+    {
+        notReady++;
+        return;
+    }
+    frames++;
+    // from the second frame on the slave returns what it received before
+    for (i = 1; i < DATASIZE; i++)
+    {
+        if (datain[i] != data[i])
+        {
+            errors++;
+            break;
+        }
+    }
+
+    now = millis();
+    if ((now - lastReport) >= 1000)
+    {
+        Serial.print("frames/s: ");
+        Serial.print(frames);
+        Serial.print(" bytes/s: ");
+        Serial.print(frames * DATASIZE);
+        Serial.print(" errors: ");
+        Serial.print(errors);
+        Serial.print(" not ready: ");
+        Serial.println(notReady);
+        frames = 0;
+        errors = 0;
+        notReady = 0;
+        lastReport = millis();
+    }
+}
@@ -0,0 +1,66 @@
+/*
+    SPI_Multi_Slave_Demo
+
+    This example Demos two logical SPI slaves on one module. Device 0 is a 16 byte register
+    map the master reads and overwrites in place, device 1 answers with a fixed ID block.
+    Each device has its own CS line; the module itself runs in 3 wire mode.
+
+    created 19 Oct 2026
+
+*/
+
+
+// include the SPI Slave library:
+#include <SPI_Slave.h>
+#include <SPI_Slave_Multi.h>
+
+#define CS_REGS 8   // CS of device 0, low = active
+#define CS_ID   12  // CS of device 1, low = active
+
+uint8_t regs[16];
+uint8_t id[4] = {0x43, 0x53, 0x01, 0x00};
+uint8_t idrx[4];
+
+void setup()
+{
+    uint8_t i;
+
+    //Initialize serial
+    Serial.begin(115200);
+
+    Serial.println("\nMulti Slave Started");
+
+    for (i = 0; i < sizeof(regs); i++)
+    {
+        regs[i] = i;
+    }
+
+    // initialize SPI Slave without STE, CS is handled per device:
+    SPISlave.begin(SPISlaveSettings(MODE_3WIRE, MSBFIRST, SPI_MODE0));
+    SPISlaveMulti.attach(0, CS_REGS, regs, regs, sizeof(regs));
+    SPISlaveMulti.attach(1, CS_ID, idrx, id, sizeof(id));
+}
+
+void loop()
+{
+    uint8_t i;
+    uint16_t len;
+
+    if (SPISlaveMulti.available(0))
+    {
+        len = SPISlaveMulti.received(0);
+        Serial.print("REGS <= ");
+        for (i = 0; i < len; i++)
+        {
+            Serial.print(regs[i], HEX);
+            Serial.print(" ");
+        }
+        Serial.println("");
+    }
+    if (SPISlaveMulti.available(1))
+    {
+        len = SPISlaveMulti.received(1);
+        Serial.print("ID read, bytes: ");
+        Serial.println(len);
+    }
+}
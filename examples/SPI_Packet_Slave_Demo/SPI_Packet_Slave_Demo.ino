@@ -0,0 +1,80 @@
+/*
+    SPI_Packet_Slave_Demo
+
+    This example Demos the framed packet layer of the SPI Slave library. The master sends
+    frames of [length][sequence][payload][CRC16] and reads the slave's frame of the same format
+    at the same time; a transfer is as long as the longer of the two frames, the slave cuts its
+    receive to that length, checks the CRC and queues the packet. Every received packet is
+    answered with its payload inverted in the following frame. After a bad frame the slave
+    waits for the CS release before it takes the next one.
+
+    created 19 Oct 2026
+
+*/
+
+
+// include the SPI Slave library:
+#include <SPI_Slave.h>
+#include <SPI_Slave_Packet.h>
+
+#define SLOTS       4
+#define MAX_PAYLOAD 32
+
+uint8_t pool[SPI_PACKET_POOL_SIZE(SLOTS, MAX_PAYLOAD)];
+uint8_t response[MAX_PAYLOAD];
+
+#define STE 8
+
+void setup()
+{
+    //Initialize serial
+    Serial.begin(115200);
+
+    Serial.println("\nPacket Slave Started");
+
+    // sync on STE
+    pinMode(STE, INPUT);
+    while (digitalRead(STE) != HIGH); // wait for High = disable -> start
+
+    // initialize SPI Slave with STE low = active:
+    SPISlave.begin(SPISlaveSettings(MODE_4WIRE_STE0, MSBFIRST, SPI_MODE0),
+                   13, /* Module */
+                   5, /* SCK */
+                   3, /* MOSI */
+                   4, /* MISO */
+                   STE, /* CS */
+                   PORT_SELECTION0 /* PIN Mode */
+                  );
+    SPISlavePacket.begin(pool, SLOTS, MAX_PAYLOAD);
+}
+
+void loop()
+{
+    uint8_t i;
+    uint8_t len;
+    uint8_t *data;
+
+    if (SPISlavePacket.available() == 0)
+    {
+        return;
+    }
+
+    len = SPISlavePacket.length();
+    data = SPISlavePacket.payload();
+    Serial.print("RX #");
+    Serial.print(SPISlavePacket.sequence());
+    Serial.print(" => ");
+    for (i = 0; i < len; i++)
+    {
+        Serial.print(data[i], HEX);
+        Serial.print(" ");
+        response[i] = ~data[i];
+    }
+    Serial.println("");
+    SPISlavePacket.release();
+
+    while (!SPISlavePacket.write(response, len));
+
+    Serial.print("CRC errors: ");
+    Serial.println(SPISlavePacket.crcErrors);
+}
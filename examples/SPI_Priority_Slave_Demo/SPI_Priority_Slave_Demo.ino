@@ -0,0 +1,89 @@
+/*
+    SPI_Priority_Slave_Demo
+
+    This example Demos the urgent and bulk response queues of the SPI Slave library. The slave
+    keeps 2 KB sample blocks queued as bulk responses and answers a button press with a short
+    urgent event, which goes out in the next frame even while bulk blocks are waiting.
+    The master reads the status byte and the length first: the low bits of the status byte tell
+    whether the frame carries the urgent event (1), a bulk block (2) or nothing (0).
+
+    created 19 Oct 2026
+
+*/
+
+
+// include the SPI Slave library:
+#include <SPI_Slave.h>
+#include <SPI_Slave_Priority.h>
+
+#define STE 8
+#define BLOCK 2048
+
+uint8_t bulk[2][SPI_PRIORITY_HEADER + BLOCK];
+uint8_t event[SPI_PRIORITY_HEADER + 4];
+uint8_t fill = 0;
+uint16_t blocks = 0;
+uint8_t lastButton = HIGH;
+
+void setup()
+{
+    //Initialize serial
+    Serial.begin(115200);
+
+    Serial.println("\nPriority Slave Started");
+
+    pinMode(PUSH1, INPUT_PULLUP);
+
+    // sync on STE
+    pinMode(STE, INPUT);
+    while (digitalRead(STE) != HIGH); // wait for High = disable -> start
+
+    // initialize SPI Slave with STE low = active:
+    SPISlave.begin(SPISlaveSettings(MODE_4WIRE_STE0, MSBFIRST, SPI_MODE0),
+                   13, /* Module */
+                   5, /* SCK */
+                   3, /* MOSI */
+                   4, /* MISO */
+                   STE, /* CS */
+                   PORT_SELECTION0 /* PIN Mode */
+                  );
+    SPISlavePriority.begin();
+}
+
+void loop()
+{
+    uint8_t button = digitalRead(PUSH1);
+    uint32_t now;
+    uint16_t i;
+
+    // refill a bulk buffer once the master has read it
+    if (SPISlavePriority.pending(SPI_PRIORITY_BULK) < 2)
+    {
+        for (i = 0; i < BLOCK; i++)
+        {
+            bulk[fill][SPI_PRIORITY_HEADER + i] = analogRead(A3) >> 2;
+        }
+        SPISlavePriority.post(SPI_PRIORITY_BULK, bulk[fill], BLOCK);
+        fill ^= 1;
+        blocks++;
+    }
+
+    // a button press is reported at once, ahead of the queued blocks
+    if ((button != lastButton) && (SPISlavePriority.pending(SPI_PRIORITY_URGENT) == 0))
+    {
+        lastButton = button;
+        now = millis();
+        event[SPI_PRIORITY_HEADER + 0] = button;
+        event[SPI_PRIORITY_HEADER + 1] = now >> 16;
+        event[SPI_PRIORITY_HEADER + 2] = now >> 8;
+        event[SPI_PRIORITY_HEADER + 3] = now;
+        SPISlavePriority.post(SPI_PRIORITY_URGENT, event, 4);
+
+        Serial.print("button: ");
+        Serial.print(button);
+        Serial.print(" blocks: ");
+        Serial.print(blocks);
+        Serial.print(" preempted: ");
+        Serial.println(SPISlavePriority.preempted);
+    }
+}
@@ -0,0 +1,70 @@
+/*
+    SPI_Queue_Slave_Demo
+
+    This example Demos the zero copy frame queue of the SPI Slave library. Each frame between
+    CS pulses is received straight into a slot of the pool and queued; the loop prints the
+    frames in place and releases the slots, while the slave keeps receiving into free slots.
+    Use it with the SPI_Master_Demo.
+
+    created 19 Oct 2026
+
+*/
+
+
+// include the SPI Slave library:
+#include <SPI_Slave.h>
+#include <SPI_Slave_Queue.h>
+
+#define SLOTS      8
+#define FRAME_SIZE 10
+
+uint8_t pool[SPI_QUEUE_POOL_SIZE(SLOTS, FRAME_SIZE)];
+
+#define STE 8
+
+void setup()
+{
+    //Initialize serial
+    Serial.begin(115200);
+
+    Serial.println("\nQueue Slave Started");
+
+    // sync on STE
+    pinMode(STE, INPUT);
+    while (digitalRead(STE) != HIGH); // wait for High = disable -> start
+
+    // initialize SPI Slave with STE low = active:
+    SPISlave.begin(SPISlaveSettings(MODE_4WIRE_STE0, MSBFIRST, SPI_MODE0),
+                   13, /* Module */
+                   5, /* SCK */
+                   3, /* MOSI */
+                   4, /* MISO */
+                   STE, /* CS */
+                   PORT_SELECTION0 /* PIN Mode */
+                  );
+    SPISlaveQueue.begin(pool, SLOTS, FRAME_SIZE);
+}
+
+void loop()
+{
+    uint16_t i;
+    uint16_t len;
+    uint8_t *frame;
+
+    if (SPISlaveQueue.available() == 0)
+    {
+        return;
+    }
+
+    frame = SPISlaveQueue.front();
+    len = SPISlaveQueue.length();
+    Serial.print("RX => "); // data received
+    for (i = 0; i < len; i++)
+    {
+        Serial.print(frame[i], HEX);
+        Serial.print(" ");
+    }
+    Serial.print(" dropped: ");
+    Serial.println(SPISlaveQueue.dropped);
+    SPISlaveQueue.release();
+}
@@ -56,7 +56,7 @@ void loop()
 
     digitalWrite(RED_LED, HIGH);   // set the LED on
     while (SPISlave.bytes_received() == 0);
-    while (SPISlave.bytes_received() == 0 && (SPISlave.getCS(STE) == LOW))
+    while (SPISlave.bytes_received() == 0 && SPISlave.csActive())
     {
         digitalWrite(GREEN_LED, HIGH);   // set the LED on
     }
@@ -0,0 +1,85 @@
+/*
+    SPI_Stream_Slave_Demo
+
+    This example Demos the stream mode of the SPI Slave library. The master clocks data without
+    any frame structure, the slave receives it into a ring (by DMA where available) and drains it
+    in large chunks: peekContiguous() processes the data in place, readBlock() copies it out.
+    The loop sums all bytes and prints throughput and lost bytes once a second.
+    Use it together with the SPI_Master_Block_Demo or any master sending a continuous stream.
+
+    created 19 Oct 2026
+
+*/
+
+
+// include the SPI Slave library:
+#include <SPI_Slave.h>
+
+#define STE 8
+
+uint8_t ring[512];
+uint8_t chunk[64];
+
+uint32_t total = 0;
+uint16_t sum = 0;
+uint32_t lastPrint = 0;
+
+void setup()
+{
+    //Initialize serial
+    Serial.begin(115200);
+
+    Serial.println("\nStream Slave Started");
+
+    // sync on STE
+    pinMode(STE, INPUT);
+    while (digitalRead(STE) != HIGH); // wait for High = disable -> start
+
+    // initialize SPI Slave with STE low = active:
+    SPISlave.begin(SPISlaveSettings(MODE_4WIRE_STE0, MSBFIRST, SPI_MODE0),
+                   13, /* Module */
+                   5, /* SCK */
+                   3, /* MOSI */
+                   4, /* MISO */
+                   STE, /* CS */
+                   PORT_SELECTION0 /* PIN Mode */
+                  );
+    SPISlave.stream(ring, sizeof(ring));
+}
+
+void loop()
+{
+    uint8_t *data;
+    uint16_t count;
+    uint16_t i;
+
+    // zero copy: work on the ring in place, one contiguous span at a time
+    while ((count = SPISlave.peekContiguous(&data)) > 64)
+    {
+        for (i = 0; i < count; i++)
+        {
+            sum += data[i];
+        }
+        SPISlave.consume(count);
+        total += count;
+    }
+
+    // a short tail is copied out instead
+    count = SPISlave.readBlock(chunk, sizeof(chunk));
+    for (i = 0; i < count; i++)
+    {
+        sum += chunk[i];
+    }
+    total += count;
+
+    if ((millis() - lastPrint) >= 1000)
+    {
+        lastPrint = millis();
+        Serial.print("bytes: ");
+        Serial.print(total);
+        Serial.print(" sum: ");
+        Serial.print(sum, HEX);
+        Serial.print(" lost: ");
+        Serial.println(SPISlave.streamLost());
+    }
+}
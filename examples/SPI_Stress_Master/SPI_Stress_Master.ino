@@ -0,0 +1,115 @@
+/*
+    SPI_Stress_Master
+
+    This example contains the SPI Master code for the SPI_Stress_Slave. Every frame has its
+    length (1 to FRAME_MAX bytes) and data derived from the frame number, it is clocked by DMA
+    with SPIMasterBlock as soon as the slave signals ready. The answer of the slave is checked
+    against the same model; errors are printed once per second.
+    Program this code to a device which should act as master and connect the 4 wires used for SPI
+    communication the the Slave *SCK, MISO, SIMO, SS (STE), and RDY to the ready output of the slave.
+
+    created 19 Oct 2026
+
+*/
+
+#define FRAME_MAX 32
+uint8_t data[FRAME_MAX];
+uint8_t datain[FRAME_MAX];
+
+// include the SPI library and the master block driver:
+#include <SPI.h>
+#include <SPI_Master_Block.h>
+
+#ifndef SS
+#define SS 5
+#endif
+
+#define RDY 11 // ready output of the slave, high = armed
+
+uint16_t frame = 0;
+uint32_t frames = 0;
+uint32_t bytes = 0;
+uint32_t errors = 0;
+uint32_t notReady = 0;
+uint32_t lastReport = 0;
+
+// model shared with the slave
+uint16_t hash(uint16_t x)
+{
+    x ^= x << 7;
+    x ^= x >> 9;
+    x ^= x << 8;
+    return (x);
+}
+
+uint16_t frameLength(uint16_t n)
+{
+    return (1 + hash(n + 1) % FRAME_MAX);
+}
+
+uint8_t masterByte(uint16_t n, uint16_t i)
+{
+    return ((i == 0) ? (n & 0xFF) : (uint8_t)(hash(n + 1) + i * 13));
+}
+
+uint8_t slaveByte(uint16_t n, uint16_t i)
+{
+    return ((uint8_t)((n * 7 + i) ^ 0x5A));
+}
+
+void setup()
+{
+    //Initialize serial
+    Serial.begin(115200);
+
+    // initialize SPI Master:
+    SPI.begin();
+    SPI.setClockDivider(4);
+    SPIMasterBlock.begin(SS);
+    SPIMasterBlock.setReadyPin(RDY, HIGH);
+    SPIMasterBlock.setGap(50); // us CS high, the slave drops ready after a short frame in its loop
+
+    Serial.println("Stress Master Started");
+    lastReport = millis();
+}
+
+void loop()
+{
+    uint16_t i;
+    uint16_t len = frameLength(frame);
+
+    for (i = 0; i < len; i++)
+    {
+        data[i] = masterByte(frame, i);
+    }
+    if (!SPIMasterBlock.transfer(datain, data, len))
+    {
+        // slave did not re-arm in time, retry the same frame
+        notReady++;
+        return;
+    }
+    for (i = 0; i < len; i++)
+    {
+        if (datain[i] != slaveByte(frame, i))
+        {
+            errors++;
+            break;
+        }
+    }
+    frames++;
+    bytes += len;
+    frame++;
+
+    if ((millis() - lastReport) >= 1000)
+    {
+        Serial.print("frames: ");
+        Serial.print(frames);
+        Serial.print(" bytes: ");
+        Serial.print(bytes);
+        Serial.print(" errors: ");
+        Serial.print(errors);
+        Serial.print(" not ready: ");
+        Serial.println(notReady);
+        lastReport = millis();
+    }
+}
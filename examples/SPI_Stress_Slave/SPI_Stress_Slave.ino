@@ -0,0 +1,162 @@
+/*
+    SPI_Stress_Slave
+
+    This example stress tests the transfer state machine of the SPI Slave library against the
+    SPI_Stress_Master. Both sides derive every frame from the frame number: its length (1 to
+    FRAME_MAX bytes), the bytes the master sends and the bytes the slave answers. Frames
+    shorter than FRAME_MAX end on the CS release, which aborts the armed transfer mid-frame.
+    The slave cycles through separate, identical (rx == tx) and overlapping (rx = tx + 1)
+    buffers, and every fifth frame is armed twice, the first time with wrong data.
+    Received bytes and counters are checked against the model, errors are printed once per second.
+
+    created 19 Oct 2026
+
+*/
+
+
+// include the SPI Slave library:
+#include <SPI_Slave.h>
+
+#define FRAME_MAX 32
+
+uint8_t buffer[2 * FRAME_MAX + 1];
+
+#define STE 8
+#define RDY 11 // ready output to the master, high = armed
+
+uint16_t frame = 0;
+uint32_t frames = 0;
+uint32_t lengthErrors = 0;
+uint32_t dataErrors = 0;
+uint32_t syncErrors = 0;
+uint32_t lastReport = 0;
+
+// model shared with the master
+uint16_t hash(uint16_t x)
+{
+    x ^= x << 7;
+    x ^= x >> 9;
+    x ^= x << 8;
+    return (x);
+}
+
+uint16_t frameLength(uint16_t n)
+{
+    return (1 + hash(n + 1) % FRAME_MAX);
+}
+
+uint8_t masterByte(uint16_t n, uint16_t i)
+{
+    return ((i == 0) ? (n & 0xFF) : (uint8_t)(hash(n + 1) + i * 13));
+}
+
+uint8_t slaveByte(uint16_t n, uint16_t i)
+{
+    return ((uint8_t)((n * 7 + i) ^ 0x5A));
+}
+
+void setup()
+{
+    //Initialize serial
+    Serial.begin(115200);
+
+    Serial.println("\nStress Slave Started");
+
+    // sync on STE
+    pinMode(STE, INPUT);
+    while (digitalRead(STE) != HIGH); // wait for High = disable -> start
+
+    // initialize SPI Slave with STE low = active:
+    SPISlave.begin(SPISlaveSettings(MODE_4WIRE_STE0, MSBFIRST, SPI_MODE0),
+                   13, /* Module */
+                   5, /* SCK */
+                   3, /* MOSI */
+                   4, /* MISO */
+                   STE, /* CS */
+                   PORT_SELECTION0 /* PIN Mode */
+                  );
+    SPISlave.setReadyPin(RDY, HIGH);
+    SPISlave.latchCSRelease(true);
+    lastReport = millis();
+}
+
+void loop()
+{
+    uint16_t i;
+    uint16_t received;
+    uint16_t expected;
+    uint8_t *tx = buffer;
+    uint8_t *rx;
+
+    switch (frame % 3)
+    {
+        case 0:
+            rx = buffer + FRAME_MAX;  // separate buffers
+            break;
+        case 1:
+            rx = buffer;              // identical buffers
+            break;
+        default:
+            rx = buffer + 1;          // overlapping, rx one byte behind tx
+            break;
+    }
+
+    if ((frame % 5) == 4)
+    {
+        // arm once with wrong data, the second arm has to replace it
+        memset(tx, 0xEE, FRAME_MAX);
+        SPISlave.transfer(rx, tx, FRAME_MAX);
+    }
+    for (i = 0; i < FRAME_MAX; i++)
+    {
+        tx[i] = slaveByte(frame, i);
+    }
+    while (SPISlave.csActive());  // end of the previous frame
+    SPISlave.csReleased();        // drop its release edge
+    SPISlave.transfer(rx, tx, FRAME_MAX);
+
+    while (!SPISlave.transactionDone() && !SPISlave.csReleased());
+    if (SPISlave.transactionDone())
+    {
+        received = SPISlave.bytes_received();
+    }
+    else
+    {
+        received = SPISlave.abort();
+    }
+
+    // the master numbers its frames in byte 0, follow it after a lost frame
+    if ((received != 0) && (rx[0] != (frame & 0xFF)))
+    {
+        syncErrors++;
+        frame = (frame & 0xFF00) | rx[0];
+    }
+    expected = frameLength(frame);
+    if (received != expected)
+    {
+        lengthErrors++;
+    }
+    for (i = 0; (i < received) && (i < expected); i++)
+    {
+        if (rx[i] != masterByte(frame, i))
+        {
+            dataErrors++;
+            break;
+        }
+    }
+    frames++;
+    frame++;
+
+    if ((millis() - lastReport) >= 1000)
+    {
+        Serial.print("frames: ");
+        Serial.print(frames);
+        Serial.print(" length errors: ");
+        Serial.print(lengthErrors);
+        Serial.print(" data errors: ");
+        Serial.print(dataErrors);
+        Serial.print(" lost: ");
+        Serial.println(syncErrors);
+        lastReport = millis();
+    }
+}
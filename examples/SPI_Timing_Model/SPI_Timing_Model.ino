@@ -0,0 +1,76 @@
+/*
+    SPI_Timing_Model
+
+    This example prints what the timing model of the SPI Slave library predicts for the board
+    it runs on: MCLK, module family and transfer mode are taken from the running slave, the
+    frame profile is set below. Feed the SCK limit and the CS gap into the master (for
+    SPIMasterBlock: setGap()) and check them with SPI_Stress_Master. The same model is
+    available on the host as extras/spi_timing.
+
+    created 19 Oct 2026
+
+*/
+
+
+// include the SPI Slave library:
+#include <SPI_Slave.h>
+
+#define FRAME 32          // bytes per frame
+#define HOOK_CYCLES 0     // cycles spent in the done and header hooks of the application
+#define MODE_EXTRA 0      // SPI_TIMING_RX_ONLY, SPI_TIMING_HEADER, SPI_TIMING_CS_END, SPI_TIMING_HALF as used
+
+void setup()
+{
+    spi_timing_profile_t profile;
+    spi_timing_t timing;
+
+    //Initialize serial
+    Serial.begin(115200);
+
+    SPISlave.begin(SPISlaveSettings(MODE_4WIRE_STE0, MSBFIRST, SPI_MODE0),
+                   13, /* Module */
+                   5, /* SCK */
+                   3, /* MOSI */
+                   4, /* MISO */
+                   8, /* CS */
+                   PORT_SELECTION0 /* PIN Mode */
+                  );
+
+    profile.mclk_hz = F_CPU >> SPISlave.mclkShift();
+#if defined(__MSP430_HAS_USI__)
+    profile.module = SPI_TIMING_USI;
+#elif defined(__MSP430_HAS_EUSCI_B0__) || defined(__MSP430_HAS_EUSCI_A0__)
+    profile.module = SPI_TIMING_EUSCI;
+#else
+    profile.module = SPI_TIMING_USCI;
+#endif
+    profile.mode = MODE_EXTRA | (SPISlave.usesDMA() ? SPI_TIMING_DMA : 0);
+    profile.frame = FRAME;
+    profile.hook_cycles = HOOK_CYCLES;
+    spi_timing_model(&profile, &timing);
+
+    Serial.println("\nSPI Slave timing model");
+    Serial.print("MCLK Hz:      ");
+    Serial.println(profile.mclk_hz);
+    Serial.print("mode:         ");
+    Serial.println(SPISlave.usesDMA() ? "DMA" : "interrupt");
+    Serial.print("cycles/byte:  ");
+    Serial.println(timing.byte_cycles);
+    Serial.print("re-arm:       ");
+    Serial.println(timing.gap_cycles);
+    Serial.print("SCK max Hz:   ");
+    Serial.println(timing.sck_max_hz);
+    if (timing.word_gap_ns)
+    {
+        Serial.print("word gap ns:  ");
+        Serial.println(timing.word_gap_ns);
+    }
+    Serial.print("CS gap ns:    ");
+    Serial.println(timing.cs_gap_ns);
+    Serial.print("frames/s:     ");
+    Serial.println(timing.frames_per_s);
+}
+
+void loop()
+{
+}
@@ -0,0 +1,73 @@
+/*
+    SPI_Window_Slave_Demo
+
+    This example Demos the memory window mode of the SPI Slave library. The slave looks like an
+    SPI SRAM to the master: READ (0x03) / FAST_READ (0x0B) / WRITE (0x02), a 16 bit address,
+    then data. The window holds a live uptime counter the master can read at any time and a
+    block of settings the master may write; the slave only prints the settings when they change.
+
+    created 19 Oct 2026
+
+*/
+
+
+// include the SPI Slave library:
+#include <SPI_Slave.h>
+#include <SPI_Slave_Window.h>
+
+struct
+{
+    uint32_t uptime;      // address 0x0000, updated by the loop
+    uint16_t loops;       // address 0x0004
+    uint8_t settings[10]; // address 0x0006, written by the master
+} shared;
+
+uint8_t lastSettings[sizeof(shared.settings)];
+
+#define STE 8
+
+void setup()
+{
+    //Initialize serial
+    Serial.begin(115200);
+
+    Serial.println("\nWindow Slave Started");
+
+    // sync on STE
+    pinMode(STE, INPUT);
+    while (digitalRead(STE) != HIGH); // wait for High = disable -> start
+
+    // initialize SPI Slave with STE low = active:
+    SPISlave.begin(SPISlaveSettings(MODE_4WIRE_STE0, MSBFIRST, SPI_MODE0),
+                   13, /* Module */
+                   5, /* SCK */
+                   3, /* MOSI */
+                   4, /* MISO */
+                   STE, /* CS */
+                   PORT_SELECTION0 /* PIN Mode */
+                  );
+    SPISlaveWindow.begin((uint8_t *)&shared, sizeof(shared));
+}
+
+void loop()
+{
+    uint8_t i;
+
+    shared.uptime = millis();
+    shared.loops++;
+
+    if (memcmp(lastSettings, shared.settings, sizeof(lastSettings)) != 0)
+    {
+        memcpy(lastSettings, shared.settings, sizeof(lastSettings));
+        Serial.print("settings => ");
+        for (i = 0; i < sizeof(lastSettings); i++)
+        {
+            Serial.print(lastSettings[i], HEX);
+            Serial.print(" ");
+        }
+        Serial.print(" reads: ");
+        Serial.print(SPISlaveWindow.reads);
+        Serial.print(" writes: ");
+        Serial.println(SPISlaveWindow.writes);
+    }
+}
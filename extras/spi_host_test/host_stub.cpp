@@ -0,0 +1,151 @@
+/*
+    host_stub.cpp - Energia core and register space for the host test builds
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+    Pins map to eight ports of eight bits each (pin n is bit n % 8 of
+    port n / 8 + 1), time is host_ms, advanced by the test.
+
+*/
+
+#include <Energia.h>
+
+#define HOST_PORTS 8
+#define HOST_ADDRS 64
+
+uint8_t host_regs[0x10000] __attribute__((aligned(2)));
+void (*host_write_hook)(uint16_t reg) = 0;
+unsigned long host_ms = 0;
+
+static volatile uint8_t port_in[HOST_PORTS + 1];
+static volatile uint8_t port_out[HOST_PORTS + 1];
+static volatile uint8_t port_dir[HOST_PORTS + 1];
+static volatile uint8_t port_sel0[HOST_PORTS + 1];
+static volatile uint8_t port_sel1[HOST_PORTS + 1];
+
+static uint16_t addr_reg[HOST_ADDRS];
+static unsigned long addr_value[HOST_ADDRS];
+
+/*
+    Full width DMA addresses, keyed by the register they were written to;
+    the register itself gets the low 16 bits.
+*/
+void host_write_addr(uint16_t reg, unsigned long value)
+{
+    uint8_t i;
+
+    for (i = 0; i < HOST_ADDRS; i++)
+    {
+        if (addr_reg[i] == reg || addr_reg[i] == 0)
+        {
+            addr_reg[i] = reg;
+            addr_value[i] = value;
+            break;
+        }
+    }
+    HWREG16(reg) = (uint16_t)value;
+}
+
+unsigned long host_addr(uint16_t reg)
+{
+    uint8_t i;
+
+    for (i = 0; i < HOST_ADDRS; i++)
+    {
+        if (addr_reg[i] == reg)
+        {
+            return (addr_value[i]);
+        }
+    }
+    return (0);
+}
+
+void usci_isr_install(void)
+{
+}
+
+uint8_t digitalPinToPort(uint8_t pin)
+{
+    return ((pin / 8 < HOST_PORTS) ? pin / 8 + 1 : NOT_A_PORT);
+}
+
+uint8_t digitalPinToBitMask(uint8_t pin)
+{
+    return (1 << (pin % 8));
+}
+
+volatile uint8_t *portInputRegister(uint8_t port)
+{
+    return (&port_in[port]);
+}
+
+volatile uint8_t *portOutputRegister(uint8_t port)
+{
+    return (&port_out[port]);
+}
+
+volatile uint8_t *portDirRegister(uint8_t port)
+{
+    return (&port_dir[port]);
+}
+
+volatile uint8_t *portSel0Register(uint8_t port)
+{
+    return (&port_sel0[port]);
+}
+
+volatile uint8_t *portSel1Register(uint8_t port)
+{
+    return (&port_sel1[port]);
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    uint8_t port = digitalPinToPort(pin);
+
+    if (mode == OUTPUT)
+    {
+        port_dir[port] |= digitalPinToBitMask(pin);
+    }
+    else
+    {
+        port_dir[port] &= ~digitalPinToBitMask(pin);
+    }
+}
+
+void pinMode_int(uint8_t pin, uint16_t mode)
+{
+    pinMode(pin, (uint8_t)(mode & OUTPUT));
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    uint8_t port = digitalPinToPort(pin);
+
+    if (value)
+    {
+        port_out[port] |= digitalPinToBitMask(pin);
+    }
+    else
+    {
+        port_out[port] &= ~digitalPinToBitMask(pin);
+    }
+}
+
+int digitalRead(uint8_t pin)
+{
+    return ((port_in[digitalPinToPort(pin)] & digitalPinToBitMask(pin)) != 0);
+}
+
+unsigned long millis(void)
+{
+    return (host_ms);
+}
+
+unsigned long micros(void)
+{
+    return (host_ms * 1000);
+}
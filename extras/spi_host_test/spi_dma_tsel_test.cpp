@@ -0,0 +1,253 @@
+/*
+    spi_dma_tsel_test.cpp - DMA trigger routing of the SPI Slave library, checked on the host
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+    Builds the real backend (spi_slave_common.cpp and the module tables)
+    against a stub device, see stub/, and checks the module map and the
+    trigger select fields spi_slave_dma_trigger() and spi_slave_setup()
+    write, for odd and even channels, and which modules
+    spi_master_block_begin() accepts next to the slave. Build and run
+    once per DMA layout:
+
+        c++ -I stub -I stub/dmax -o tsel_dmax spi_dma_tsel_test.cpp host_stub.cpp \
+            ../../utility/spi_slave_common.cpp ../../utility/eusci_spi_slave.cpp \
+            ../../utility/usci_spi_slave.cpp
+        ./tsel_dmax
+
+        c++ -I stub -I stub/f2xx -o tsel_f2xx spi_dma_tsel_test.cpp host_stub.cpp \
+            ../../utility/spi_slave_common.cpp ../../utility/eusci_spi_slave.cpp \
+            ../../utility/usci_spi_slave.cpp
+        ./tsel_f2xx
+
+    dmax is laid out like the FR5994 (eUSCI, DMAX with 5 bit fields, two
+    channels per DMACTLx), f2xx like the F2618 (USCI, three 4 bit fields in
+    DMACTL0). The expected numbers are taken from the device datasheets,
+    not from the library's macros. Exit status 1 on any failure.
+
+*/
+
+#include <stdio.h>
+#include <Energia.h>
+#include "../../utility/spi_slave_common.h"
+
+#if !SPI_SLAVE_DMA
+#error "build against a stub device with DMA, -I stub/dmax or -I stub/f2xx"
+#endif
+
+unsigned long host_addr(uint16_t reg);
+
+typedef struct
+{
+    uint8_t module;
+    uint8_t chan;
+    uint8_t rx;
+    uint8_t tx;
+} expected_t;
+
+#if SPI_SLAVE_HAS_DMA == 1
+#define CHANNELS 6
+#define FIELD_MASK 0x1F
+static const expected_t expected[] =
+{
+    { 0,  0,            18, 19 },
+    { 1,  3,            18, 19 },
+    { 2,  SPI_DMA_NONE,  0,  0 },
+    { 3,  SPI_DMA_NONE,  0,  0 },
+    { 10, 0,            14, 15 },
+    { 11, 0,            16, 17 },
+    { 12, 3,            14, 15 },
+    { 13, 3,            16, 17 },
+};
+
+/* DMACTL0 holds channels 0 and 1, DMACTL1 2 and 3, ...; odd channels in the high byte */
+static uint16_t field_reg(uint8_t chan)
+{
+    return (DMA_BASE + OFS_DMACTL0 + (chan / 2) * 2);
+}
+
+static uint8_t field_shift(uint8_t chan)
+{
+    return ((chan % 2) ? 8 : 0);
+}
+#else
+#define CHANNELS 3
+#define FIELD_MASK 0x0F
+static const expected_t expected[] =
+{
+    { 0,  0, 12, 13 },
+    { 10, 0,  3,  4 },
+};
+
+/* DMA0TSELx in bits 0..3 of DMACTL0, DMA1TSELx in 4..7, DMA2TSELx in 8..11 */
+static uint16_t field_reg(uint8_t chan)
+{
+    (void)chan;
+    return (DMACTL0_);
+}
+
+static uint8_t field_shift(uint8_t chan)
+{
+    return (chan * 4);
+}
+#endif
+
+#define EXPECTED (sizeof(expected) / sizeof(expected[0]))
+
+static unsigned checks = 0;
+static unsigned failures = 0;
+
+static void check(int ok, const char *what, unsigned a, unsigned b)
+{
+    checks++;
+    if (!ok)
+    {
+        failures++;
+        printf("FAIL %s (%u, %u)\n", what, a, b);
+    }
+}
+
+static uint8_t field(uint8_t chan)
+{
+    return ((HWREG16(field_reg(chan)) >> field_shift(chan)) & FIELD_MASK);
+}
+
+static void clear_fields(uint16_t fill)
+{
+    uint8_t chan;
+
+    for (chan = 0; chan < CHANNELS; chan++)
+    {
+        HWREG16(field_reg(chan)) = fill;
+    }
+}
+
+/* the module table: every module of the device, trigger numbers unshifted */
+static void test_module_map(void)
+{
+    uint8_t i;
+    uint8_t j;
+
+    check(spi_slave_module_count == EXPECTED, "module count", spi_slave_module_count, EXPECTED);
+    for (i = 0; i < EXPECTED; i++)
+    {
+        const spi_slave_module_t *m = 0;
+
+        for (j = 0; j < spi_slave_module_count; j++)
+        {
+            if (spi_slave_modules[j].module == expected[i].module)
+            {
+                m = &spi_slave_modules[j];
+            }
+        }
+        check(m != 0, "module present", expected[i].module, 0);
+        if (m == 0)
+        {
+            continue;
+        }
+        check(m->dma_chan == expected[i].chan, "channel", m->module, m->dma_chan);
+        check(m->rxbuf == m->base + OFS_UCzRXBUF, "rx buffer", m->module, m->rxbuf);
+        check(m->txbuf == m->base + OFS_UCzTXBUF, "tx buffer", m->module, m->txbuf);
+        if (m->dma_chan != SPI_DMA_NONE)
+        {
+            check(m->rx_trigger == expected[i].rx, "rx trigger", m->module, m->rx_trigger);
+            check(m->tx_trigger == expected[i].tx, "tx trigger", m->module, m->tx_trigger);
+        }
+    }
+}
+
+/* spi_slave_dma_trigger(): only the field of the channel changes */
+static void test_trigger_fields(void)
+{
+    uint8_t chan;
+    uint8_t other;
+    uint8_t value;
+    uint16_t fill;
+
+    for (fill = 0; fill <= 1; fill++)
+    {
+        for (chan = 0; chan < CHANNELS; chan++)
+        {
+            for (value = 0; value <= FIELD_MASK; value++)
+            {
+                clear_fields(fill ? 0xFFFF : 0x0000);
+                spi_slave_dma_trigger(chan, value);
+                check(field(chan) == value, "field", chan, value);
+                for (other = 0; other < CHANNELS; other++)
+                {
+                    if (other != chan)
+                    {
+                        check(field(other) == (fill ? FIELD_MASK : 0), "neighbour field", chan, other);
+                    }
+                }
+                check((HWREG16(field_reg(chan)) & ~(FIELD_MASK << field_shift(chan)))
+                      == (fill ? (uint16_t)~(FIELD_MASK << field_shift(chan)) : 0),
+                      "bits outside the fields", chan, value);
+            }
+        }
+    }
+}
+
+/* spi_slave_setup(): RX trigger on the pair's first channel, TX on the second */
+static void test_setup(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < spi_slave_module_count; i++)
+    {
+        const spi_slave_module_t *m = &spi_slave_modules[i];
+        uint8_t chan = m->dma_chan;
+
+        clear_fields(0x0000);
+        SPI_slave_baseAddress = m->base;
+        spiSlaveModule = m->module;
+        spi_slave_setup(0);
+        check(spi_slave_uses_dma() == (chan != SPI_DMA_NONE), "uses dma", m->module, spi_slave_uses_dma());
+        if (chan == SPI_DMA_NONE)
+        {
+            continue;
+        }
+        check(field(chan) == m->rx_trigger, "rx channel field", m->module, field(chan));
+        check(field(chan + 1) == m->tx_trigger, "tx channel field", m->module, field(chan + 1));
+        check(host_addr(SPI_DMA_CH0 + chan * SPI_DMA_STRIDE + SPI_DMA_SA) == m->rxbuf, "rx source", m->module, chan);
+        check(host_addr(SPI_DMA_CH0 + (chan + 1) * SPI_DMA_STRIDE + SPI_DMA_DA) == m->txbuf, "tx destination", m->module, chan);
+    }
+}
+
+/* spi_master_block_begin(): any module but the slave's, on a channel pair the slave leaves free */
+static void test_master_block(void)
+{
+    uint8_t i;
+    uint8_t j;
+
+    check(spi_master_module_count == EXPECTED, "master module count", spi_master_module_count, EXPECTED);
+    for (i = 0; i < spi_slave_module_count; i++)
+    {
+        const spi_slave_module_t *s = &spi_slave_modules[i];
+
+        SPI_slave_baseAddress = s->base;
+        spiSlaveModule = s->module;
+        spi_slave_setup(0);
+        for (j = 0; j < spi_master_module_count; j++)
+        {
+            const spi_slave_module_t *m = &spi_master_modules[j];
+            uint8_t free = (m->dma_chan != SPI_DMA_NONE) && (m->module != s->module)
+                           && ((s->dma_chan == SPI_DMA_NONE) || (m->dma_chan != s->dma_chan));
+
+            check(spi_master_block_begin(m->module) == free, "master block", s->module, m->module);
+        }
+    }
+}
+
+int main(void)
+{
+    test_module_map();
+    test_trigger_fields();
+    test_setup();
+    test_master_block();
+    printf("%u checks, %u failures\n", checks, failures);
+    return (failures ? 1 : 0);
+}
@@ -0,0 +1,531 @@
+/*
+    spi_stress_test.cpp - randomized stress test of the SPI Slave transfer state machine, on the host
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+    Runs the real backend (spi_slave_common.cpp, eusci_spi_slave.cpp,
+    spi_slave_stats.cpp) on a byte level model of an eUSCI slave and the
+    DMAX controller, see stub/dmax, and plays random master frames against
+    it: random transfer and receive lengths, frames shorter and longer than
+    the armed transfer, aborts and CS closes mid-frame, re-arms during an
+    active transfer, spi_slave_rearm(), separate, identical (rx == tx),
+    overlapping (rx = tx + 1) and absent rx buffers, frame timer on and
+    off. Every byte the slave sends, the memory it writes, the byte counts,
+    the done hook and the statistics are checked against a reference model.
+    Build and run:
+
+        c++ -I stub -I stub/dmax -DSPI_SLAVE_DMA_VECTOR=0 -DSPI_SLAVE_STATS=1 \
+            -o spi_stress spi_stress_test.cpp host_stub.cpp \
+            ../../utility/spi_slave_common.cpp ../../utility/eusci_spi_slave.cpp \
+            ../../utility/usci_spi_slave.cpp ../../utility/spi_slave_stats.cpp
+        ./spi_stress [steps] [seed]
+
+    Each run covers interrupt mode (eUSCI_B2, no DMA trigger) and DMA
+    mode (eUSCI_A3 on channels 3 and 4). The model services flags between
+    bytes, at once: it checks the state machine, not its timing (see
+    extras/spi_timing). The RX interrupt is taken as reading UCzRXBUF.
+    Exit status 1 on any failure.
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <Energia.h>
+#include "../../utility/spi_slave_common.h"
+#include "../../utility/spi_slave_stats.h"
+
+#if (SPI_SLAVE_HAS_DMA != 1) || !SPI_SLAVE_DMA || SPI_SLAVE_DMA_VECTOR || !SPI_SLAVE_STATS
+#error "build with -I stub/dmax -DSPI_SLAVE_DMA_VECTOR=0 -DSPI_SLAVE_STATS=1"
+#endif
+
+unsigned long host_addr(uint16_t reg);
+extern unsigned long host_ms;
+
+#define MEMORY 256
+#define FRAME_MAX 64
+#define TX_AT 32                 /* tx buffer in memory */
+#define RX_AT 128                /* separate rx buffer */
+
+/*
+    eUSCI slave: UCzTXBUF, the shift register and the flags; DMAX: the
+    channel pair of the module, with its temporary address and size
+    registers loaded on the DMAEN edge.
+*/
+typedef struct
+{
+    uint8_t enabled;
+    unsigned long src;
+    unsigned long dst;
+    uint16_t size;
+} dma_t;
+
+static uint16_t base;            /* module under test */
+static uint16_t ofs_ie;
+static uint16_t ofs_ifg;
+static uint16_t ofs_stat;
+static uint8_t dma_chan;         /* RX channel, SPI_DMA_NONE without DMA */
+static uint8_t rx_trigger;
+static uint8_t tx_trigger;
+static uint8_t tx_full;
+static uint8_t shift;
+static uint16_t underruns;
+static dma_t dma[2];
+
+static unsigned checks = 0;
+static unsigned failures = 0;
+
+static void check(int ok, const char *what, unsigned long step, unsigned a, unsigned b)
+{
+    checks++;
+    if (!ok)
+    {
+        failures++;
+        if (failures <= 20)
+        {
+            printf("FAIL step %lu: %s (%u, %u)\n", step, what, a, b);
+        }
+    }
+}
+
+static uint16_t dma_reg(uint8_t chan, uint16_t reg)
+{
+    return (SPI_DMA_CH0 + chan * SPI_DMA_STRIDE + reg);
+}
+
+static volatile uint8_t *dma_mem(unsigned long addr)
+{
+    return ((addr < 0x10000) ? &host_regs[addr] : (volatile uint8_t *)addr);
+}
+
+static uint8_t dma_routed(uint8_t chan, uint8_t trigger)
+{
+    uint16_t reg = DMA_BASE + OFS_DMACTL0 + (chan / 2) * 2;
+
+    return (((HWREG16(reg) >> ((chan % 2) * 8)) & 0x1F) == trigger);
+}
+
+/* stores of the backend: module reset, TX buffer loads and DMA enables */
+static void on_write(uint16_t reg)
+{
+    uint8_t i;
+
+    if ((reg == base) && (HWREG16(base) & UCSWRST))
+    {
+        /* UCSWRST clears the enables, UCRXIFG and UCOE, sets UCTXIFG */
+        host_regs[base + ofs_ie] = 0;
+        host_regs[base + ofs_ifg] = UCTXIFG;
+        host_regs[base + ofs_stat] &= ~UCOE;
+        tx_full = 0;
+        return;
+    }
+    if (reg == base + OFS_UCBxTXBUF)
+    {
+        host_regs[base + ofs_ifg] &= ~UCTXIFG;
+        tx_full = 1;
+        return;
+    }
+    for (i = 0; (dma_chan != SPI_DMA_NONE) && (i < 2); i++)
+    {
+        uint8_t chan = dma_chan + i;
+
+        if (reg == dma_reg(chan, SPI_DMA_CTL))
+        {
+            uint16_t ctl = HWREG16(reg);
+
+            if ((ctl & DMAEN) && !dma[i].enabled)
+            {
+                dma[i].src = host_addr(dma_reg(chan, SPI_DMA_SA));
+                dma[i].dst = host_addr(dma_reg(chan, SPI_DMA_DA));
+                dma[i].size = HWREG16(dma_reg(chan, SPI_DMA_SZ));
+            }
+            dma[i].enabled = (ctl & DMAEN) != 0;
+        }
+    }
+}
+
+/* one single transfer of channel i; at the end DMAxSZ reloads, DMAEN clears, DMAIFG sets */
+static void dma_move(uint8_t i)
+{
+    uint8_t chan = dma_chan + i;
+    uint16_t ctl = HWREG16(dma_reg(chan, SPI_DMA_CTL));
+
+    *dma_mem(dma[i].dst) = *dma_mem(dma[i].src);
+    if (ctl & DMASRCINCR)
+    {
+        dma[i].src++;
+    }
+    if (ctl & DMADSTINCR)
+    {
+        dma[i].dst++;
+    }
+    *(volatile uint16_t *)&host_regs[dma_reg(chan, SPI_DMA_SZ)] -= 1;
+    if (HWREG16(dma_reg(chan, SPI_DMA_SZ)) == 0)
+    {
+        *(volatile uint16_t *)&host_regs[dma_reg(chan, SPI_DMA_SZ)] = dma[i].size;
+        *(volatile uint16_t *)&host_regs[dma_reg(chan, SPI_DMA_CTL)] = (ctl & ~DMAEN) | DMAIFG;
+        dma[i].enabled = 0;
+        if (ctl & DMAIE)
+        {
+            spi_slave_dma_handler();
+        }
+    }
+}
+
+/* hand pending flags to DMA first, then to the interrupts, until nothing is left */
+static void service(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < 100; i++)
+    {
+        uint8_t ifg = host_regs[base + ofs_ifg];
+        uint8_t ie = host_regs[base + ofs_ie];
+
+        if ((ifg & UCRXIFG) && dma[0].enabled && dma_routed(dma_chan, rx_trigger))
+        {
+            host_regs[base + ofs_ifg] &= ~UCRXIFG;
+            dma_move(0);
+        }
+        else if ((ifg & UCTXIFG) && dma[1].enabled && dma_routed(dma_chan + 1, tx_trigger))
+        {
+            /* the TX trigger reloads UCzTXBUF, DMAxDA points at it */
+            dma_move(1);
+            host_regs[base + ofs_ifg] &= ~UCTXIFG;
+            tx_full = 1;
+        }
+        else if ((ifg & UCRXIFG) && (ie & UCRXIE))
+        {
+            spi_rx_isr(0);
+            host_regs[base + ofs_ifg] &= ~UCRXIFG;
+            host_regs[base + ofs_stat] &= ~UCOE;
+        }
+        else
+        {
+            return;
+        }
+    }
+    check(0, "flags keep firing", 0, host_regs[base + ofs_ifg], host_regs[base + ofs_ie]);
+}
+
+/* the master clocks one byte */
+static uint8_t clock_byte(uint8_t mosi)
+{
+    uint8_t miso;
+
+    if (tx_full)
+    {
+        shift = host_regs[base + OFS_UCBxTXBUF];
+        tx_full = 0;
+        host_regs[base + ofs_ifg] |= UCTXIFG;
+    }
+    else
+    {
+        underruns++;  /* UCzTXBUF not loaded, the last byte goes out again */
+    }
+    miso = shift;
+    service();
+    if (host_regs[base + ofs_ifg] & UCRXIFG)
+    {
+        host_regs[base + ofs_stat] |= UCOE;
+    }
+    host_regs[base + OFS_UCBxRXBUF] = mosi;
+    host_regs[base + ofs_ifg] |= UCRXIFG;
+    service();
+    return (miso);
+}
+
+static void select_module(uint8_t module)
+{
+    uint8_t i;
+
+    for (i = 0; i < spi_slave_module_count; i++)
+    {
+        if (spi_slave_modules[i].module == module)
+        {
+            base = spi_slave_modules[i].base;
+            dma_chan = spi_slave_modules[i].dma_chan;
+            rx_trigger = spi_slave_modules[i].rx_trigger;
+            tx_trigger = spi_slave_modules[i].tx_trigger;
+        }
+    }
+    ofs_ie = (module < 10) ? OFS_UCBxIE : OFS_UCAxIE;
+    ofs_ifg = (module < 10) ? OFS_UCBxIFG : OFS_UCAxIFG;
+    ofs_stat = (module < 10) ? OFS_UCBxSTATW : OFS_UCAxSTATW;
+    memset(host_regs, 0, sizeof(host_regs));
+    memset(dma, 0, sizeof(dma));
+    tx_full = 0;
+    shift = 0;
+    underruns = 0;
+    SPI_slave_baseAddress = base;
+    spiSlaveModule = module;
+    spi_slave_initialize(1, 0, MSBFIRST);
+}
+
+/*
+    Reference model of one armed transfer: what the slave has to send and
+    where the received bytes have to land; everything else in memory stays.
+*/
+static uint8_t memory[MEMORY];
+static uint8_t expect[MEMORY];   /* memory as it has to be */
+static uint8_t *arm_rx;
+static uint8_t arm_receive;
+static uint8_t sends[FRAME_MAX]; /* bytes the slave sends, captured at the arm */
+static uint16_t arm_count;
+static uint16_t got;             /* master bytes since the arm */
+static uint8_t open;             /* counted by the statistics on its end */
+static uint32_t frames;
+static uint32_t bytes;
+static uint16_t aborts;
+static uint16_t hook_calls;
+static uint16_t hook_received;
+
+static uint32_t seed = 1;
+
+static uint32_t random32(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return (seed);
+}
+
+static uint16_t below(uint16_t n)
+{
+    return ((uint16_t)(random32() % n));
+}
+
+static void done_hook(uint16_t received)
+{
+    hook_calls++;
+    hook_received = received;
+}
+
+static uint16_t min16(uint16_t a, uint16_t b)
+{
+    return ((a < b) ? a : b);
+}
+
+static void check_memory(unsigned long step)
+{
+    uint16_t i;
+
+    for (i = 0; i < MEMORY; i++)
+    {
+        if (memory[i] != expect[i])
+        {
+            check(0, "memory", step, i, memory[i]);
+            memcpy(memory, expect, sizeof(memory));
+            return;
+        }
+    }
+    check(1, "memory", step, 0, 0);
+}
+
+static void check_state(unsigned long step)
+{
+    uint16_t received = min16(got, arm_count);
+    uint32_t ms;
+    spi_slave_stats_t stats;
+
+    check(spi_bytes_received() == received, "bytes received", step, spi_bytes_received(), received);
+    check((spi_data_done() != 0) == (got >= arm_count), "data done", step, spi_data_done(), got);
+    check(hook_calls == (got >= arm_count), "done hook calls", step, hook_calls, got);
+    if (hook_calls)
+    {
+        check(hook_received == arm_count, "done hook count", step, hook_received, arm_count);
+    }
+    if (got < arm_count)
+    {
+        check(spi_slave_frame_started(&ms) == (got != 0), "frame started", step, got, 0);
+    }
+    spi_slave_stats_read(&stats);
+    check(stats.frames == frames, "stats frames", step, stats.frames, frames);
+    check(stats.bytes == bytes, "stats bytes", step, stats.bytes, bytes);
+    check(stats.aborts == aborts, "stats aborts", step, stats.aborts, aborts);
+    check_memory(step);
+}
+
+/* arm a transfer or receive of count bytes, rx at one of the buffer layouts */
+static void arm(unsigned long step, uint8_t again)
+{
+    uint8_t *tx = memory + TX_AT;
+    uint8_t *rx;
+    uint16_t count = arm_count;
+    uint8_t receive = 0;
+    uint16_t i;
+
+    if (again)
+    {
+        /* spi_slave_rearm(): same buffers and count, tx as it is now */
+        rx = arm_rx;
+        receive = arm_receive;
+    }
+    else
+    {
+        count = 1 + below(FRAME_MAX);
+        switch (below(4))
+        {
+            case 0:
+                rx = memory + RX_AT;
+                break;
+            case 1:
+                rx = tx;
+                break;
+            case 2:
+                rx = tx + 1;
+                break;
+            default:
+                rx = 0;
+                break;
+        }
+        receive = (below(4) == 0);
+        for (i = 0; i < MEMORY; i++)
+        {
+            memory[i] = (uint8_t)random32();
+        }
+    }
+    memcpy(expect, memory, sizeof(memory));
+    for (i = 0; i < count; i++)
+    {
+        sends[i] = receive ? 0xFF : tx[i];
+    }
+    arm_rx = rx;
+    arm_receive = receive;
+    arm_count = count;
+    got = 0;
+    hook_calls = 0;
+    open = 1;
+    spi_slave_set_frame_timer(below(2));
+    if (again)
+    {
+        check(spi_slave_rearm() == 1, "rearm", step, 0, 0);
+    }
+    else if (receive)
+    {
+        spi_slave_receive(rx, count);
+    }
+    else
+    {
+        spi_slave_transfer(rx, tx, count);
+    }
+    check_state(step);
+}
+
+/* the master clocks n bytes of a frame */
+static void clock_bytes(unsigned long step, uint16_t n)
+{
+    uint8_t mosi;
+    uint8_t miso;
+    uint16_t held;
+
+    while (n--)
+    {
+        mosi = (uint8_t)random32();
+        held = underruns;
+        miso = clock_byte(mosi);
+        if (got < arm_count)
+        {
+            check(miso == sends[got], "slave byte", step, got, miso);
+            check(underruns == held, "underrun", step, got, 0);
+            if (arm_rx)
+            {
+                expect[arm_rx - memory + got] = mosi;
+            }
+            if (got + 1 == arm_count)
+            {
+                frames++;
+                bytes += arm_count;
+                open = 0;
+            }
+        }
+        got++;
+        host_ms++;
+    }
+    check_state(step);
+}
+
+static void run(const char *mode, uint8_t module, unsigned long steps)
+{
+    unsigned long step;
+    uint16_t received;
+    unsigned checked = checks;
+    unsigned failed = failures;
+
+    select_module(module);
+    spi_slave_set_done_hook(done_hook);
+    spi_slave_stats_clear();
+    frames = 0;
+    bytes = 0;
+    aborts = 0;
+    arm(0, 0);
+    for (step = 1; step <= steps; step++)
+    {
+        switch (below(8))
+        {
+            case 0:
+            case 1:
+            case 2:
+                clock_bytes(step, below(arm_count - min16(got, arm_count) + 4));
+                break;
+            case 3:
+                received = spi_slave_abort();
+                check(received == min16(got, arm_count), "abort count", step, received, got);
+                aborts += open;
+                open = 0;
+                arm(step, below(4) == 0);
+                break;
+            case 4:
+                received = spi_slave_close();
+                check(received == min16(got, arm_count), "close count", step, received, got);
+                if (open && received)
+                {
+                    frames++;
+                    bytes += received;
+                }
+                open = 0;
+                arm(step, below(4) == 0);
+                break;
+            case 5:
+                /* re-arm in the middle of the master's frame, the partial frame is not counted */
+                check_memory(step);
+                if (open)
+                {
+                    arm(step, 0);
+                }
+                else
+                {
+                    arm(step, below(2));
+                }
+                break;
+            default:
+                if (got >= arm_count)
+                {
+                    arm(step, below(4) == 0);
+                }
+                else
+                {
+                    clock_bytes(step, arm_count - got);
+                }
+                break;
+        }
+    }
+    printf("%s: %u checks, %u failures\n", mode, checks - checked, failures - failed);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long steps = (argc > 1) ? strtoul(argv[1], 0, 0) : 20000;
+
+    seed = (argc > 2) ? strtoul(argv[2], 0, 0) : 1;
+    if (seed == 0)
+    {
+        seed = 1;
+    }
+    host_write_hook = on_write;
+    run("interrupt mode", 2, steps);
+    run("DMA mode", 13, steps);
+    return (failures ? 1 : 0);
+}
@@ -0,0 +1,41 @@
+/*
+    Energia.h - the part of the Energia core the SPI Slave backends use, for host builds
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+*/
+
+#ifndef _HOST_ENERGIA_H_
+#define _HOST_ENERGIA_H_
+
+#include <stdint.h>
+#include <msp430.h>
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define NOT_A_PORT 0
+#define MSBFIRST 1
+#define LSBFIRST 0
+#define PORT_SELECTION0 0x10
+#define PORT_SELECTION1 0x20
+
+uint8_t digitalPinToPort(uint8_t pin);
+uint8_t digitalPinToBitMask(uint8_t pin);
+volatile uint8_t *portInputRegister(uint8_t port);
+volatile uint8_t *portOutputRegister(uint8_t port);
+volatile uint8_t *portDirRegister(uint8_t port);
+volatile uint8_t *portSel0Register(uint8_t port);
+volatile uint8_t *portSel1Register(uint8_t port);
+void pinMode(uint8_t pin, uint8_t mode);
+void pinMode_int(uint8_t pin, uint16_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+unsigned long millis(void);
+unsigned long micros(void);
+
+#endif /*_HOST_ENERGIA_H_*/
@@ -0,0 +1,109 @@
+/*
+    msp430.h - eUSCI + DMAX device for host builds, laid out like the MSP430FR5994
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+    Only what the SPI Slave backends use. eUSCI_A0/A1/B0 trigger on DMA
+    channels 0..2, A2/A3/B1 on channels 3..5, B2/B3 have no trigger.
+
+*/
+
+#ifndef _HOST_MSP430_H_
+#define _HOST_MSP430_H_
+
+#include "host_regs.h"
+
+#define __MSP430_HAS_EUSCI_A0__
+#define __MSP430_HAS_EUSCI_A1__
+#define __MSP430_HAS_EUSCI_A2__
+#define __MSP430_HAS_EUSCI_A3__
+#define __MSP430_HAS_EUSCI_B0__
+#define __MSP430_HAS_EUSCI_B1__
+#define __MSP430_HAS_EUSCI_B2__
+#define __MSP430_HAS_EUSCI_B3__
+#define __MSP430_BASEADDRESS_EUSCI_A0__ 0x05C0
+#define __MSP430_BASEADDRESS_EUSCI_A1__ 0x05E0
+#define __MSP430_BASEADDRESS_EUSCI_A2__ 0x0600
+#define __MSP430_BASEADDRESS_EUSCI_A3__ 0x0620
+#define __MSP430_BASEADDRESS_EUSCI_B0__ 0x0640
+#define __MSP430_BASEADDRESS_EUSCI_B1__ 0x0680
+#define __MSP430_BASEADDRESS_EUSCI_B2__ 0x06C0
+#define __MSP430_BASEADDRESS_EUSCI_B3__ 0x0700
+
+#define OFS_UCBxCTLW0  0x0000
+#define OFS_UCBxCTL0   0x0001
+#define OFS_UCBxCTL1   0x0000
+#define OFS_UCBxBRW    0x0006
+#define OFS_UCBxBR0    0x0006
+#define OFS_UCBxBR1    0x0007
+#define OFS_UCBxSTATW  0x0008
+#define OFS_UCBxRXBUF  0x000C
+#define OFS_UCBxTXBUF  0x000E
+#define OFS_UCBxIE     0x002A
+#define OFS_UCBxIFG    0x002C
+#define OFS_UCBxIV     0x002E
+#define OFS_UCAxSTATW  0x000A
+#define OFS_UCAxIE     0x001A
+#define OFS_UCAxIFG    0x001C
+#define OFS_UCAxIV     0x001E
+
+#define UCSWRST        0x0001
+#define UCSTEM         0x0002
+#define UCSSEL__SMCLK  0x0080
+#define UCSYNC         0x0100
+#define UCMODE_0       0x0000
+#define UCMODE_1       0x0200
+#define UCMODE_2       0x0400
+#define UCMODE_3       0x0600
+#define UCMST          0x0800
+#define UCMSB          0x2000
+#define UCCKPL         0x4000
+#define UCCKPH         0x8000
+#define UCBUSY         0x01
+#define UCOE           0x20
+#define UCRXIE         0x01
+#define UCTXIE         0x02
+#define UCRXIFG        0x01
+#define UCTXIFG        0x02
+
+#define __MSP430_HAS_DMAX_6__
+#define DMA_BASE       0x0500
+#define OFS_DMACTL0    0x0000
+#define OFS_DMACTL1    0x0002
+#define OFS_DMACTL2    0x0004
+#define OFS_DMACTL4    0x0008
+#define OFS_DMAIV      0x000E
+#define OFS_DMA0CTL    0x0010
+#define OFS_DMA1CTL    0x0020
+#define DMA_VECTOR     0
+
+#define DMADT_0        0x0000
+#define DMADT_4        0x4000
+#define DMADSTINCR     0x0C00
+#define DMADSTINCR_3   0x0C00
+#define DMASRCINCR     0x0300
+#define DMASRCINCR_3   0x0300
+#define DMASBDB        0x00C0
+#define DMALEVEL       0x0020
+#define DMAEN          0x0010
+#define DMAIFG         0x0008
+#define DMAIE          0x0004
+
+/* trigger selects, even channels in bits 0..4 and odd channels in bits 8..12 of their DMACTLx */
+#define DMA0TSEL__UCA0RXIFG   (14 * 0x0001u)
+#define DMA1TSEL__UCA0TXIFG   (15 * 0x0100u)
+#define DMA0TSEL__UCA1RXIFG   (16 * 0x0001u)
+#define DMA1TSEL__UCA1TXIFG   (17 * 0x0100u)
+#define DMA0TSEL__UCB0RXIFG0  (18 * 0x0001u)
+#define DMA1TSEL__UCB0TXIFG0  (19 * 0x0100u)
+#define DMA3TSEL__UCA2RXIFG   (14 * 0x0100u)
+#define DMA4TSEL__UCA2TXIFG   (15 * 0x0001u)
+#define DMA3TSEL__UCA3RXIFG   (16 * 0x0100u)
+#define DMA4TSEL__UCA3TXIFG   (17 * 0x0001u)
+#define DMA3TSEL__UCB1RXIFG0  (18 * 0x0100u)
+#define DMA4TSEL__UCB1TXIFG0  (19 * 0x0001u)
+
+#endif /*_HOST_MSP430_H_*/
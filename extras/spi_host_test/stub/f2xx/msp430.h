@@ -0,0 +1,62 @@
+/*
+    msp430.h - USCI + F2xx DMA device for host builds, laid out like the MSP430F2618
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+    Only what the SPI Slave backends use. IE2/IFG2 and the three 4 bit
+    trigger fields of DMACTL0 live in the host register space.
+
+*/
+
+#ifndef _HOST_MSP430_H_
+#define _HOST_MSP430_H_
+
+#include "host_regs.h"
+
+#define __MSP430_HAS_USCI__
+#define IE2            HWREG8(0x0001)
+#define IFG2           HWREG8(0x0003)
+#define UCA0RXIE       0x01
+#define UCA0TXIE       0x02
+#define UCB0RXIE       0x04
+#define UCB0TXIE       0x08
+#define UCA0RXIFG      0x01
+#define UCA0TXIFG      0x02
+#define UCB0RXIFG      0x04
+#define UCB0TXIFG      0x08
+
+#define UCSWRST        0x01
+#define UCSSEL_2       0x80
+#define UCSYNC         0x01
+#define UCMODE_0       0x00
+#define UCMODE_1       0x02
+#define UCMODE_2       0x04
+#define UCMODE_3       0x06
+#define UCMST          0x08
+#define UCMSB          0x20
+#define UCCKPL         0x40
+#define UCCKPH         0x80
+#define UCBUSY         0x01
+#define UCOE           0x20
+
+#define __MSP430_HAS_DMA_3__
+#define DMACTL0_       0x0122
+#define DMA0CTL_       0x01D0
+#define DMA1CTL_       0x01DC
+#define DACDMA_VECTOR  0
+
+#define DMADT_0        0x0000
+#define DMADT_4        0x4000
+#define DMADSTINCR_3   0x0C00
+#define DMASRCINCR_3   0x0300
+#define DMASRCBYTE     0x0040
+#define DMADSTBYTE     0x0080
+#define DMALEVEL       0x0020
+#define DMAEN          0x0010
+#define DMAIFG         0x0008
+#define DMAIE          0x0004
+
+#endif /*_HOST_MSP430_H_*/
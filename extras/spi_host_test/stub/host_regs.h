@@ -0,0 +1,114 @@
+/*
+    host_regs.h - peripheral space of the host test builds
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+    The 64k msp430 address space as a plain array, HWREG8/HWREG16 and
+    __data16_write_addr() of the library land in it, so the register
+    accesses of the backends can be checked and driven on the host.
+    Every store through HWREG8/HWREG16 is passed to host_write_hook, a
+    peripheral model can act on it (UCSWRST, UCzTXBUF, DMAEN); loads
+    have no side effects.
+
+*/
+
+#ifndef _HOST_REGS_H_
+#define _HOST_REGS_H_
+
+#include <stdint.h>
+#include <string.h>
+
+extern uint8_t host_regs[0x10000];
+extern void (*host_write_hook)(uint16_t reg);
+
+template <typename T> class host_reg;
+
+/*
+    &HWREG16(x): a pointer to the register, plain pointers bypass the hook.
+    As a DMA address it is the register's msp430 address, below 0x10000
+    and so apart from any host pointer.
+*/
+template <typename T> class host_ptr
+{
+  public:
+    explicit host_ptr(uint16_t reg) : reg(reg) {}
+    host_reg<T> operator*() const
+    {
+        return (host_reg<T>(reg));
+    }
+    operator volatile T *() const
+    {
+        return ((volatile T *)(host_regs + reg));
+    }
+    operator unsigned long() const  /* DMA address of the register */
+    {
+        return (reg);
+    }
+
+  private:
+    uint16_t reg;
+};
+
+template <typename T> class host_reg
+{
+  public:
+    explicit host_reg(uint16_t reg) : reg(reg) {}
+    operator T() const
+    {
+        return (*(volatile T *)(host_regs + reg));
+    }
+    host_reg &operator=(T value)
+    {
+        *(volatile T *)(host_regs + reg) = value;
+        if (host_write_hook)
+        {
+            host_write_hook(reg);
+        }
+        return (*this);
+    }
+    host_reg &operator=(const host_reg &other)
+    {
+        return (*this = (T)other);
+    }
+    host_reg &operator|=(T bits)
+    {
+        return (*this = (T)(*this | bits));
+    }
+    host_reg &operator&=(T bits)
+    {
+        return (*this = (T)(*this & bits));
+    }
+    host_reg &operator^=(T bits)
+    {
+        return (*this = (T)(*this ^ bits));
+    }
+    host_ptr<T> operator&() const
+    {
+        return (host_ptr<T>(reg));
+    }
+
+  private:
+    uint16_t reg;
+};
+
+#define HWREG8(x)   host_reg<uint8_t>((uint16_t)(x))
+#define HWREG16(x)  host_reg<uint16_t>((uint16_t)(x))
+#define __data16_write_addr(x, y) host_write_addr((uint16_t)(x), (unsigned long)(y))
+
+/* DMA addresses are 20 bit on the device, host pointers do not fit; see host_addr() */
+void host_write_addr(uint16_t reg, unsigned long value);
+
+#define interrupt(x)
+#define __disable_interrupt()   do {} while (0)
+#define __enable_interrupt()    do {} while (0)
+#define __no_operation()        do {} while (0)
+#define __even_in_range(x, y)   (x)
+#define __get_SR_register()     0
+#define __bis_SR_register(x)    ((void)(x))
+#define __bic_SR_register(x)    do {} while (0)
+#define GIE                     0x0008
+
+#endif /*_HOST_REGS_H_*/
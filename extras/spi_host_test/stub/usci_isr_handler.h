@@ -0,0 +1,2 @@
+/* host build: the Energia core's shared USCI vector, see host_stub.cpp */
+void usci_isr_install(void);
@@ -0,0 +1,188 @@
+/*
+    spi_timing.c - SCK ceiling and CS gap calculator for the SPI Slave library
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+    Host tool around the timing model of utility/spi_slave_timing.h, the
+    same model the library uses for MCLK scaling. Build and run with
+
+        cc -std=c99 -O2 -o spi_timing spi_timing.c
+        ./spi_timing -m 16000000 -u eusci -d -f 64
+        ./spi_timing -m 8000000 -d -s -f 6
+
+    Options:
+        -m hz       MCLK of the slave (F_CPU >> mclkShift())
+        -u family   eusci (default), usci or usi
+        -d          DMA, default is the RX interrupt
+        -r          receive() only, the slave sends dummy bytes
+        -H cycles   header hook sizes each frame, cycles spent in the hooks
+        -c          frames end on the CS release (abort and re-arm)
+        -s          halfDuplex() on a single data line, frame = command + response
+        -f bytes    bytes per frame, default 16
+        -a          table of all modes for the given MCLK and frame
+
+    The figures are estimates; check them against the board with
+    SPI_Stress_Master or SPI_Energy_Benchmark before provisioning a master.
+
+*/
+
+#define _POSIX_C_SOURCE 200809L  /* getopt() and optarg under -std=c99 */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../utility/spi_slave_timing.h"
+
+static const char *family_name[] = { "eusci", "usci", "usi" };
+
+static const char *mode_name(uint8_t mode)
+{
+    static char name[48];
+
+    snprintf(name, sizeof(name), "%s %s%s%s%s",
+             (mode & SPI_TIMING_DMA) ? "dma" : "isr",
+             (mode & SPI_TIMING_RX_ONLY) ? "rx-only" : "duplex",
+             (mode & SPI_TIMING_HEADER) ? " header" : "",
+             (mode & SPI_TIMING_CS_END) ? " cs-end" : "",
+             (mode & SPI_TIMING_HALF) ? " half" : "");
+    return (name);
+}
+
+static void print_result(const spi_timing_profile_t *p, const spi_timing_t *t, int verbose)
+{
+    if (verbose)
+    {
+        printf("module      %s\n", family_name[p->module]);
+        printf("mode        %s\n", mode_name(p->mode));
+        printf("MCLK        %lu Hz\n", (unsigned long)p->mclk_hz);
+        printf("frame       %u bytes, hooks %u cycles\n", p->frame, p->hook_cycles);
+        printf("per byte    %u cycles\n", t->byte_cycles);
+        if (t->header_cycles)
+        {
+            printf("header      %u cycles\n", t->header_cycles);
+        }
+        if (t->word_cycles)
+        {
+            printf("per word    %u cycles\n", t->word_cycles);
+        }
+        printf("re-arm      %u cycles\n", t->gap_cycles);
+        if (t->turn_cycles)
+        {
+            printf("turnaround  %u cycles, %lu ns\n", t->turn_cycles, (unsigned long)t->turn_ns);
+        }
+        printf("SCK max     %lu Hz\n", (unsigned long)t->sck_max_hz);
+        if (t->word_gap_ns)
+        {
+            printf("word gap    %lu ns\n", (unsigned long)t->word_gap_ns);
+        }
+        printf("CS gap      %lu ns (setGap(%lu))\n", (unsigned long)t->cs_gap_ns,
+               (unsigned long)((t->cs_gap_ns + 999) / 1000));
+        printf("frames/s    %lu\n", (unsigned long)t->frames_per_s);
+        return;
+    }
+    printf("%-26s %9lu %9lu %9lu %9lu\n", mode_name(p->mode),
+           (unsigned long)t->sck_max_hz, (unsigned long)t->word_gap_ns,
+           (unsigned long)t->cs_gap_ns, (unsigned long)t->frames_per_s);
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "usage: %s -m mclk_hz [-u eusci|usci|usi] [-d] [-r] [-H cycles] [-c] [-s] [-f bytes] [-a]\n", name);
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    static const uint8_t modes[] =
+    {
+        0, SPI_TIMING_RX_ONLY, SPI_TIMING_DMA, SPI_TIMING_DMA | SPI_TIMING_RX_ONLY,
+    };
+    spi_timing_profile_t p;
+    spi_timing_t t;
+    int all = 0;
+    int opt;
+    unsigned i;
+
+    memset(&p, 0, sizeof(p));
+    p.module = SPI_TIMING_EUSCI;
+    p.frame = 16;
+
+    while ((opt = getopt(argc, argv, "m:u:drH:csf:a")) != -1)
+    {
+        switch (opt)
+        {
+            case 'm':
+                p.mclk_hz = strtoul(optarg, 0, 0);
+                break;
+            case 'u':
+                for (i = 0; i < 3; i++)
+                {
+                    if (strcmp(optarg, family_name[i]) == 0)
+                    {
+                        break;
+                    }
+                }
+                if (i == 3)
+                {
+                    usage(argv[0]);
+                }
+                p.module = i;
+                break;
+            case 'd':
+                p.mode |= SPI_TIMING_DMA;
+                break;
+            case 'r':
+                p.mode |= SPI_TIMING_RX_ONLY;
+                break;
+            case 'H':
+                p.mode |= SPI_TIMING_HEADER;
+                p.hook_cycles = strtoul(optarg, 0, 0);
+                break;
+            case 'c':
+                p.mode |= SPI_TIMING_CS_END;
+                break;
+            case 's':
+                p.mode |= SPI_TIMING_HALF;
+                break;
+            case 'f':
+                p.frame = strtoul(optarg, 0, 0);
+                break;
+            case 'a':
+                all = 1;
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if (p.mclk_hz == 0)
+    {
+        usage(argv[0]);
+    }
+
+    if (!all)
+    {
+        spi_timing_model(&p, &t);
+        print_result(&p, &t, 1);
+        return (0);
+    }
+
+    printf("%s, MCLK %lu Hz, %u byte frames\n", family_name[p.module], (unsigned long)p.mclk_hz, p.frame);
+    printf("mode                         SCK max  word gap    CS gap  frames/s\n");
+    printf("                                  Hz        ns        ns\n");
+    for (i = 0; i < sizeof(modes); i++)
+    {
+        if ((p.module == SPI_TIMING_USI) && (modes[i] & SPI_TIMING_DMA))
+        {
+            continue;  /* no DMA trigger */
+        }
+        p.mode = modes[i] | (p.mode & (SPI_TIMING_HEADER | SPI_TIMING_CS_END | SPI_TIMING_HALF));
+        spi_timing_model(&p, &t);
+        print_result(&p, &t, 0);
+    }
+    return (0);
+}
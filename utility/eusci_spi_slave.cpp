@@ -11,42 +11,19 @@
     or the GNU Lesser General Public License version 2.1, both as
     published by the Free Software Foundation.
 
+    Only the eUSCI specific part is here: module addresses, DMA triggers
+    and the mode setup. Transfers, hooks and interrupt handlers are shared
+    with the other family in spi_slave_common.cpp.
+
 */
 
 #include <msp430.h>
 #include <stdint.h>
-#include "spi_slave_430.h"
+#include "spi_slave_common.h"
 #include <Energia.h>
 #include "usci_isr_handler.h"
 
-#if defined(__MSP430_HAS_EUSCI_B0__) || defined(DEFAULT_SPI)
-
-
-#if defined(__MSP430_HAS_EUSCI_B0__)
-#define UCB0_BASE __MSP430_BASEADDRESS_EUSCI_B0__
-#endif
-#if defined(__MSP430_HAS_EUSCI_B1__)
-#define UCB1_BASE __MSP430_BASEADDRESS_EUSCI_B1__
-#endif
-#if defined(__MSP430_HAS_EUSCI_B2__)
-#define UCB2_BASE __MSP430_BASEADDRESS_EUSCI_B2__
-#endif
-#if defined(__MSP430_HAS_EUSCI_B3__)
-#define UCB3_BASE __MSP430_BASEADDRESS_EUSCI_B3__
-#endif
-
-#if defined(__MSP430_HAS_EUSCI_A0__)
-#define UCA0_BASE __MSP430_BASEADDRESS_EUSCI_A0__
-#endif
-#if defined(__MSP430_HAS_EUSCI_A1__)
-#define UCA1_BASE __MSP430_BASEADDRESS_EUSCI_A1__
-#endif
-#if defined(__MSP430_HAS_EUSCI_A2__)
-#define UCA2_BASE __MSP430_BASEADDRESS_EUSCI_A2__
-#endif
-#if defined(__MSP430_HAS_EUSCI_A3__)
-#define UCA3_BASE __MSP430_BASEADDRESS_EUSCI_A3__
-#endif
+#if defined(__MSP430_HAS_EUSCI_B0__) || defined(__MSP430_HAS_EUSCI_A0__)
 
 
 #if defined(DEFAULT_SPI)
@@ -79,26 +56,6 @@ uint16_t SPI_slave_baseAddress = UCB0_BASE;
 #endif
 
 
-#define UCzCTLW0     (*((volatile uint16_t *)((uint16_t)(OFS_UCBxCTLW0  + SPI_slave_baseAddress))))
-#define UCzCTL0      (*((volatile uint8_t *) ((uint16_t)(OFS_UCBxCTL0   + SPI_slave_baseAddress))))
-#define UCzCTL1      (*((volatile uint8_t *) ((uint16_t)(OFS_UCBxCTL1   + SPI_slave_baseAddress))))
-#define UCzBRW       (*((volatile uint16_t *)((uint16_t)(OFS_UCBxBRW    + SPI_slave_baseAddress))))
-#define UCzBR0       (*((volatile uint8_t *) ((uint16_t)(OFS_UCBxBR0    + SPI_slave_baseAddress))))
-#define UCzBR1       (*((volatile uint8_t *) ((uint16_t)(OFS_UCBxBR1    + SPI_slave_baseAddress))))
-#define UCzSTATW     ( (spiSlaveModule < 10) ? (*((volatile uint8_t *) ((uint16_t)(OFS_UCBxSTATW  + SPI_slave_baseAddress)))) : (*((volatile uint8_t *) ((uint16_t)(OFS_UCAxSTATW  + SPI_slave_baseAddress)))) )
-#define UCzTXBUF     (*((volatile uint8_t *) ((uint16_t)(OFS_UCBxTXBUF  + SPI_slave_baseAddress))))
-#define UCzRXBUF     (*((volatile uint8_t *) ((uint16_t)(OFS_UCBxRXBUF  + SPI_slave_baseAddress))))
-#define UCzIFG       ( (spiSlaveModule < 10) ? (*((volatile uint8_t *) ((uint16_t)(OFS_UCBxIFG    + SPI_slave_baseAddress)))) : (*((volatile uint8_t *) ((uint16_t)(OFS_UCAxIFG    + SPI_slave_baseAddress)))) )
-#define UCzIE        ( (spiSlaveModule < 10) ? (*((volatile uint8_t *) ((uint16_t)(OFS_UCBxIE     + SPI_slave_baseAddress)))) : (*((volatile uint8_t *) ((uint16_t)(OFS_UCAxIE     + SPI_slave_baseAddress)))) )
-
-#ifndef __data16_write_addr
-#define __data16_write_addr(x,y) *(unsigned long int*)(x) = y
-#endif
-#ifndef HWREG16
-#define HWREG16(x)                                                             \
-    (*((volatile uint16_t*)((uint16_t)x)))
-#endif
-
 #if defined(DEFAULT_SPI)
 uint8_t spiSlaveModule = DEFAULT_SPI;
 #else
@@ -120,53 +77,164 @@ uint8_t spiSlaveModule = 0;
 
 #define SPI_MODE_MASK (UCCKPL | UCCKPH)
 
-uint8_t * rxptr;
-uint8_t * txptr;
-uint16_t rxcount = 0;
-uint16_t txcount = 0;
-uint16_t rxrecived = 0;
-uint8_t com_mode = 0; /* mode : 0 - RX and TX  1 - RX only, TX to dummy */
-#define COM_MODE_RX  0x1
-#define COM_MODE_DMA 0x2
-
-uint8_t dma_idx = 0; /* index to DMA channel */
-
-const uint8_t dummy = 0xFF;
-
 /**
-    spi_slave_initialize() - Configure USCI UCz for SPI mode
-
-    Pxx - CS (active low)
-    Pxx - SCLK
-    Pxx - MISO aka SOMI
-    Pxx - MOSI aka SIMO
-
+    DMA triggers of the eUSCI modules, see the module map in spi_slave_common.h.
 */
 
-void spi_slave_initialize(const uint8_t mode, const uint8_t datamode, const uint8_t order)
+#if defined(DMA0TSEL__UCB0RXIFG0) && defined(DMA1TSEL__UCB0TXIFG0)
+#define UCB0_DMA   0, DMA0TSEL__UCB0RXIFG0, DMA1TSEL__UCB0TXIFG0
+#elif defined(DMA0TSEL__UCB0RXIFG) && defined(DMA1TSEL__UCB0TXIFG)
+#define UCB0_DMA   0, DMA0TSEL__UCB0RXIFG, DMA1TSEL__UCB0TXIFG
+#elif defined(DMA3TSEL__UCB0RXIFG0) && defined(DMA4TSEL__UCB0TXIFG0)
+#define UCB0_DMA   3, DMA3TSEL__UCB0RXIFG0, DMA4TSEL__UCB0TXIFG0
+#elif defined(DMA3TSEL__UCB0RXIFG) && defined(DMA4TSEL__UCB0TXIFG)
+#define UCB0_DMA   3, DMA3TSEL__UCB0RXIFG, DMA4TSEL__UCB0TXIFG
+#else
+#define UCB0_DMA   SPI_DMA_NONE, 0, 0
+#endif
+#if defined(DMA0TSEL__UCB1RXIFG0) && defined(DMA1TSEL__UCB1TXIFG0)
+#define UCB1_DMA   0, DMA0TSEL__UCB1RXIFG0, DMA1TSEL__UCB1TXIFG0
+#elif defined(DMA0TSEL__UCB1RXIFG) && defined(DMA1TSEL__UCB1TXIFG)
+#define UCB1_DMA   0, DMA0TSEL__UCB1RXIFG, DMA1TSEL__UCB1TXIFG
+#elif defined(DMA3TSEL__UCB1RXIFG0) && defined(DMA4TSEL__UCB1TXIFG0)
+#define UCB1_DMA   3, DMA3TSEL__UCB1RXIFG0, DMA4TSEL__UCB1TXIFG0
+#elif defined(DMA3TSEL__UCB1RXIFG) && defined(DMA4TSEL__UCB1TXIFG)
+#define UCB1_DMA   3, DMA3TSEL__UCB1RXIFG, DMA4TSEL__UCB1TXIFG
+#else
+#define UCB1_DMA   SPI_DMA_NONE, 0, 0
+#endif
+#if defined(DMA0TSEL__UCB2RXIFG0) && defined(DMA1TSEL__UCB2TXIFG0)
+#define UCB2_DMA   0, DMA0TSEL__UCB2RXIFG0, DMA1TSEL__UCB2TXIFG0
+#elif defined(DMA0TSEL__UCB2RXIFG) && defined(DMA1TSEL__UCB2TXIFG)
+#define UCB2_DMA   0, DMA0TSEL__UCB2RXIFG, DMA1TSEL__UCB2TXIFG
+#elif defined(DMA3TSEL__UCB2RXIFG0) && defined(DMA4TSEL__UCB2TXIFG0)
+#define UCB2_DMA   3, DMA3TSEL__UCB2RXIFG0, DMA4TSEL__UCB2TXIFG0
+#elif defined(DMA3TSEL__UCB2RXIFG) && defined(DMA4TSEL__UCB2TXIFG)
+#define UCB2_DMA   3, DMA3TSEL__UCB2RXIFG, DMA4TSEL__UCB2TXIFG
+#else
+#define UCB2_DMA   SPI_DMA_NONE, 0, 0
+#endif
+#if defined(DMA0TSEL__UCB3RXIFG0) && defined(DMA1TSEL__UCB3TXIFG0)
+#define UCB3_DMA   0, DMA0TSEL__UCB3RXIFG0, DMA1TSEL__UCB3TXIFG0
+#elif defined(DMA0TSEL__UCB3RXIFG) && defined(DMA1TSEL__UCB3TXIFG)
+#define UCB3_DMA   0, DMA0TSEL__UCB3RXIFG, DMA1TSEL__UCB3TXIFG
+#elif defined(DMA3TSEL__UCB3RXIFG0) && defined(DMA4TSEL__UCB3TXIFG0)
+#define UCB3_DMA   3, DMA3TSEL__UCB3RXIFG0, DMA4TSEL__UCB3TXIFG0
+#elif defined(DMA3TSEL__UCB3RXIFG) && defined(DMA4TSEL__UCB3TXIFG)
+#define UCB3_DMA   3, DMA3TSEL__UCB3RXIFG, DMA4TSEL__UCB3TXIFG
+#else
+#define UCB3_DMA   SPI_DMA_NONE, 0, 0
+#endif
+#if defined(DMA0TSEL__UCA0RXIFG) && defined(DMA1TSEL__UCA0TXIFG)
+#define UCA0_DMA   0, DMA0TSEL__UCA0RXIFG, DMA1TSEL__UCA0TXIFG
+#elif defined(DMA3TSEL__UCA0RXIFG) && defined(DMA4TSEL__UCA0TXIFG)
+#define UCA0_DMA   3, DMA3TSEL__UCA0RXIFG, DMA4TSEL__UCA0TXIFG
+#else
+#define UCA0_DMA   SPI_DMA_NONE, 0, 0
+#endif
+#if defined(DMA0TSEL__UCA1RXIFG) && defined(DMA1TSEL__UCA1TXIFG)
+#define UCA1_DMA   0, DMA0TSEL__UCA1RXIFG, DMA1TSEL__UCA1TXIFG
+#elif defined(DMA3TSEL__UCA1RXIFG) && defined(DMA4TSEL__UCA1TXIFG)
+#define UCA1_DMA   3, DMA3TSEL__UCA1RXIFG, DMA4TSEL__UCA1TXIFG
+#else
+#define UCA1_DMA   SPI_DMA_NONE, 0, 0
+#endif
+#if defined(DMA0TSEL__UCA2RXIFG) && defined(DMA1TSEL__UCA2TXIFG)
+#define UCA2_DMA   0, DMA0TSEL__UCA2RXIFG, DMA1TSEL__UCA2TXIFG
+#elif defined(DMA3TSEL__UCA2RXIFG) && defined(DMA4TSEL__UCA2TXIFG)
+#define UCA2_DMA   3, DMA3TSEL__UCA2RXIFG, DMA4TSEL__UCA2TXIFG
+#else
+#define UCA2_DMA   SPI_DMA_NONE, 0, 0
+#endif
+#if defined(DMA0TSEL__UCA3RXIFG) && defined(DMA1TSEL__UCA3TXIFG)
+#define UCA3_DMA   0, DMA0TSEL__UCA3RXIFG, DMA1TSEL__UCA3TXIFG
+#elif defined(DMA3TSEL__UCA3RXIFG) && defined(DMA4TSEL__UCA3TXIFG)
+#define UCA3_DMA   3, DMA3TSEL__UCA3RXIFG, DMA4TSEL__UCA3TXIFG
+#else
+#define UCA3_DMA   SPI_DMA_NONE, 0, 0
+#endif
+
+const spi_slave_module_t spi_slave_modules[] =
 {
-    /*  Calling this dummy function prevents the linker
-        from stripping the USCI interupt vectors.*/
-    usci_isr_install();
+#if defined(UCB0_BASE) && SPI_SLAVE_MODULE_USED(0)
+    SPI_SLAVE_MODULE(0, UCB0_BASE, UCB0_DMA),
+#endif
+#if defined(UCB1_BASE) && SPI_SLAVE_MODULE_USED(1)
+    SPI_SLAVE_MODULE(1, UCB1_BASE, UCB1_DMA),
+#endif
+#if defined(UCB2_BASE) && SPI_SLAVE_MODULE_USED(2)
+    SPI_SLAVE_MODULE(2, UCB2_BASE, UCB2_DMA),
+#endif
+#if defined(UCB3_BASE) && SPI_SLAVE_MODULE_USED(3)
+    SPI_SLAVE_MODULE(3, UCB3_BASE, UCB3_DMA),
+#endif
+#if defined(UCA0_BASE) && SPI_SLAVE_MODULE_USED(10)
+    SPI_SLAVE_MODULE(10, UCA0_BASE, UCA0_DMA),
+#endif
+#if defined(UCA1_BASE) && SPI_SLAVE_MODULE_USED(11)
+    SPI_SLAVE_MODULE(11, UCA1_BASE, UCA1_DMA),
+#endif
+#if defined(UCA2_BASE) && SPI_SLAVE_MODULE_USED(12)
+    SPI_SLAVE_MODULE(12, UCA2_BASE, UCA2_DMA),
+#endif
+#if defined(UCA3_BASE) && SPI_SLAVE_MODULE_USED(13)
+    SPI_SLAVE_MODULE(13, UCA3_BASE, UCA3_DMA),
+#endif
+};
 
-    /* Put USCI in reset mode, source USCI clock from SMCLK. */
-    UCzCTLW0 = UCSWRST;
+const uint8_t spi_slave_module_count = sizeof(spi_slave_modules) / sizeof(spi_slave_modules[0]);
 
-    /* SPI in slave MODE 0 - CPOL=0 SPHA=0. - 3 wire STE */
-    UCzCTLW0 |= UCSYNC;
+#if SPI_SLAVE_DMA
+/* every module of the device, SPI_SLAVE_ONLY_MODULE limits the slave only */
+const spi_slave_module_t spi_master_modules[] =
+{
+#if defined(UCB0_BASE)
+    SPI_SLAVE_MODULE(0, UCB0_BASE, UCB0_DMA),
+#endif
+#if defined(UCB1_BASE)
+    SPI_SLAVE_MODULE(1, UCB1_BASE, UCB1_DMA),
+#endif
+#if defined(UCB2_BASE)
+    SPI_SLAVE_MODULE(2, UCB2_BASE, UCB2_DMA),
+#endif
+#if defined(UCB3_BASE)
+    SPI_SLAVE_MODULE(3, UCB3_BASE, UCB3_DMA),
+#endif
+#if defined(UCA0_BASE)
+    SPI_SLAVE_MODULE(10, UCA0_BASE, UCA0_DMA),
+#endif
+#if defined(UCA1_BASE)
+    SPI_SLAVE_MODULE(11, UCA1_BASE, UCA1_DMA),
+#endif
+#if defined(UCA2_BASE)
+    SPI_SLAVE_MODULE(12, UCA2_BASE, UCA2_DMA),
+#endif
+#if defined(UCA3_BASE)
+    SPI_SLAVE_MODULE(13, UCA3_BASE, UCA3_DMA),
+#endif
+};
+
+const uint8_t spi_master_module_count = sizeof(spi_master_modules) / sizeof(spi_master_modules[0]);
+#endif
 
-    UCzCTLW0 = (UCzCTLW0 & ~UCMSB) | ((order == 1 /*MSBFIRST*/) ? UCMSB : 0); /* MSBFIRST = 1 */
+/* UCzCTLW0 bits for wire mode, SPI mode and bit order */
+static uint16_t spi_slave_ctl_bits(const uint8_t mode, const uint8_t datamode, const uint8_t order)
+{
+    uint16_t bits = (order == 1 /*MSBFIRST*/) ? UCMSB : 0; /* MSBFIRST = 1 */
 
     switch (mode)
     {
         case 0: /* 3 wire  */
-            UCzCTLW0 |= UCMODE_0;
+            bits |= UCMODE_0;
             break;
         case 1: /* 4 wire STE = 1 */
-            UCzCTLW0 |= UCMODE_1;
+            bits |= UCMODE_1;
             break;
         case 2: /* 4 wire STE = 0 */
-            UCzCTLW0 |= UCMODE_2;
+            bits |= UCMODE_2;
+            break;
+        case 3: /* 3 wire, one data line */
+            bits |= UCMODE_0;
             break;
         default:
             break;
@@ -175,360 +243,80 @@ void spi_slave_initialize(const uint8_t mode, const uint8_t datamode, const uint
     switch (datamode)
     {
         case 0: /* SPI_MODE0 */
-            UCzCTLW0 |= SPI_MODE_0;
+            bits |= SPI_MODE_0;
             break;
         case 1: /* SPI_MODE1 */
-            UCzCTLW0 |= SPI_MODE_1;
+            bits |= SPI_MODE_1;
             break;
         case 2: /* SPI_MODE2 */
-            UCzCTLW0 |= SPI_MODE_2;
+            bits |= SPI_MODE_2;
             break;
         case 3: /* SPI_MODE3 */
-            UCzCTLW0 |= SPI_MODE_3;
+            bits |= SPI_MODE_3;
             break;
         default:
             break;
     }
-#if defined(__MSP430_HAS_DMA__)
-    com_mode = COM_MODE_DMA;
-#else
-    com_mode = 0;
-#endif
-    /* Set pins to SPI mode. */
-#if defined(DEFAULT_SPI)
-#if defined(UCB0_BASE)
-    if (SPI_slave_baseAddress == UCB0_BASE)
-    {
-#if defined(__MSP430_HAS_DMA__) && defined(DMA0TSEL__UCB0RXIFG) && defined(DMA0TSEL__UCB0TXIFG)
-        dma_idx = OFS_DMA0SA - OFS_DMA0SA;
-        if (com_mode & COM_MODE_DMA)
-        {
-            DMACTL0 = (DMACTL0 & ~DMA0TSEL__DMAE0) | DMA0TSEL__UCB0RXIFG;
+    return (bits);
+}
 
-            __data16_write_addr((unsigned short)(DMA_BASE + OFS_DMA0SA), (unsigned long)&UCB0RXBUF);
+/**
+    spi_slave_initialize() - Configure USCI UCz for SPI mode
 
-            DMACTL0 = (DMACTL0 & ~DMA1TSEL__DMAE0) | DMA1TSEL__UCB0TXIFG;
-            __data16_write_addr((unsigned short)(DMA_BASE + OFS_DMA1DA), (unsigned long)&UCB0TXBUF);
-        }
-#else
-        com_mode &= ~COM_MODE_DMA;
-#endif
-    }
-#endif
-#if defined(UCB1_BASE)
-    if (SPI_slave_baseAddress == UCB1_BASE)
-    {
-#if defined(__MSP430_HAS_DMA__) && defined(DMA0TSEL__UCB1RXIFG) && defined(DMA0TSEL__UCB1TXIFG)
-        if (com_mode & COM_MODE_DMA)
-        {
-            dma_idx = OFS_DMA0SA - OFS_DMA0SA;
-            DMACTL0 = (DMACTL0 & ~DMA0TSEL__DMAE0) | DMA0TSEL__UCB1RXIFG;
-            __data16_write_addr((unsigned short)(DMA_BASE + OFS_DMA0SA), (unsigned long)&UCB1RXBUF);
-
-            DMACTL0 = (DMACTL0 & ~DMA1TSEL__DMAE0) | DMA1TSEL__UCB1TXIFG;
-            __data16_write_addr((unsigned short)(DMA_BASE + OFS_DMA1DA), (unsigned long)&UCB1TXBUF);
-        }
-#else
-        com_mode &= ~COM_MODE_DMA;
-#endif
-    }
-#endif
-#if defined(UCB2_BASE)
-    if (SPI_slave_baseAddress == UCB2_BASE)
-    {
-#if defined(__MSP430_HAS_DMA__) && defined(DMA0TSEL__UCB2RXIFG) && defined(DMA0TSEL__UCB2TXIFG)
-        if (com_mode & COM_MODE_DMA)
-        {
-            dma_idx = OFS_DMA0SA - OFS_DMA0SA;
-            DMACTL0 = (DMACTL0 & ~DMA0TSEL__DMAE0) | DMA0TSEL__UCB2RXIFG;
-            __data16_write_addr((unsigned short)(DMA_BASE + OFS_DMA0SA), (unsigned long)&UCB2RXBUF);
-
-            DMACTL0 = (DMACTL0 & ~DMA1TSEL__DMAE0) | DMA1TSEL__UCB2TXIFG;
-            __data16_write_addr((unsigned short)(DMA_BASE + OFS_DMA1DA), (unsigned long)&UCB2TXBUF);
-        }
-#else
-        com_mode &= ~COM_MODE_DMA;
-#endif
-    }
-#endif
-#if defined(UCB3_BASE)
-    if (SPI_slave_baseAddress == UCB3_BASE)
-    {
-#if defined(__MSP430_HAS_DMA__) && defined(DMA0TSEL__UCB3RXIFG) && defined(DMA0TSEL__UCB3TXIFG)
-        if (com_mode & COM_MODE_DMA)
-        {
-            dma_idx = OFS_DMA0SA - OFS_DMA0SA;
-            DMACTL0 = (DMACTL0 & ~DMA0TSEL__DMAE0) | DMA0TSEL__UCB3RXIFG;
-            __data16_write_addr((unsigned short)(DMA_BASE + OFS_DMA0SA), (unsigned long)&UCB3RXBUF);
-
-            DMACTL0 = (DMACTL0 & ~DMA1TSEL__DMAE0) | DMA1TSEL__UCB3TXIFG;
-            __data16_write_addr((unsigned short)(DMA_BASE + OFS_DMA1DA), (unsigned long)&UCB3TXBUF);
-        }
-#else
-        com_mode &= ~COM_MODE_DMA;
-#endif
-    }
-#endif
-#if defined(UCA0_BASE)
-    if (SPI_slave_baseAddress == UCA0_BASE)
-    {
-#if defined(__MSP430_HAS_DMA__) && defined(DMA0TSEL__UCA0RXIFG) && defined(DMA1TSEL__UCA0TXIFG)
-        if (com_mode & COM_MODE_DMA)
-        {
-            dma_idx = OFS_DMA0SA - OFS_DMA0SA;
-            DMACTL0 = (DMACTL0 & ~DMA0TSEL__DMAE0) | DMA0TSEL__UCA0RXIFG;
-            __data16_write_addr((unsigned short)(DMA_BASE + OFS_DMA0SA), (unsigned long)&UCA0RXBUF);
-
-            DMACTL0 = (DMACTL0 & ~DMA1TSEL__DMAE0) | DMA1TSEL__UCA0TXIFG;
-            __data16_write_addr((unsigned short)(DMA_BASE + OFS_DMA1DA), (unsigned long)&UCA0TXBUF);
-        }
-#else
-        com_mode &= ~COM_MODE_DMA;
-#endif
-    }
-#endif
-#if defined(UCA1_BASE)
-    if (SPI_slave_baseAddress == UCA1_BASE)
-    {
-#if defined(__MSP430_HAS_DMA__) && defined(DMA0TSEL__UCA1RXIFG) && defined(DMA1TSEL__UCA1TXIFG)
-        if (com_mode & COM_MODE_DMA)
-        {
-            dma_idx = OFS_DMA0SA - OFS_DMA0SA;
-            DMACTL0 = (DMACTL0 & ~DMA0TSEL__DMAE0) | DMA0TSEL__UCA0RXIFG;
-            __data16_write_addr((unsigned short)(DMA_BASE + OFS_DMA0SA), (unsigned long)&UCA1RXBUF);
-
-            DMACTL0 = (DMACTL0 & ~DMA1TSEL__DMAE0) | DMA1TSEL__UCA1TXIFG;
-            __data16_write_addr((unsigned short)(DMA_BASE + OFS_DMA1DA), (unsigned long)&UCA1TXBUF);
-        }
-#else
-        com_mode &= ~COM_MODE_DMA;
-#endif
-    }
-#endif
-#if defined(UCA2_BASE)
-    if (SPI_slave_baseAddress == UCA2_BASE)
-    {
-#if defined(__MSP430_HAS_DMA__) && defined(DMA3TSEL__UCA2RXIFG) && defined(DMA4TSEL__UCA2TXIFG)
-        if (com_mode & COM_MODE_DMA)
-        {
-            dma_idx = OFS_DMA3SA - OFS_DMA0SA;
-            DMACTL1 = (DMACTL1 & ~DMA3TSEL__DMAE0) | DMA3TSEL__UCA2RXIFG;
-            __data16_write_addr((unsigned short)(DMA_BASE + OFS_DMA3SA), (unsigned long)&UCA2RXBUF);
-
-            DMACTL2 = (DMACTL2 & ~DMA4TSEL__DMAE0) | DMA4TSEL__UCA2TXIFG;
-            __data16_write_addr((unsigned short)(DMA_BASE + OFS_DMA4DA), (unsigned long)&UCA2TXBUF);
-        }
-#else
-        com_mode &= ~COM_MODE_DMA;
-#endif
-    }
-#endif
-#if defined(UCA3_BASE)
-    if (SPI_slave_baseAddress == UCA3_BASE)
-    {
-#if defined(__MSP430_HAS_DMA__) && defined(DMA3TSEL__UCA3RXIFG) && defined(DMA4TSEL__UCA3TXIFG)
-        if (com_mode & COM_MODE_DMA)
-        {
-            dma_idx = OFS_DMA3SA - OFS_DMA0SA;
-            DMACTL1 = (DMACTL1 & ~DMA3TSEL__DMAE0) | DMA3TSEL__UCA3RXIFG;
-            __data16_write_addr((unsigned short)(DMA_BASE + OFS_DMA3SA), (unsigned long)&UCA3RXBUF);
-
-            DMACTL2 = (DMACTL2 & ~DMA4TSEL__DMAE0) | DMA4TSEL__UCA3TXIFG;
-            __data16_write_addr((unsigned short)(DMA_BASE + OFS_DMA4DA), (unsigned long)&UCA3TXBUF);
-        }
-#else
-        com_mode &= ~COM_MODE_DMA;
-#endif
-    }
-#endif
-#else // #if defined(DEFAULT_SPI)
-#if defined(__MSP430_HAS_DMA__) && defined(DMA0TSEL__UCA0RXIFG) && defined(DMA1TSEL__UCA0TXIFG)
-    if (com_mode & COM_MODE_DMA)
-    {
-        dma_idx = OFS_DMA0SA - OFS_DMA0SA;
-        DMACTL0 = (DMACTL0 & ~DMA0TSEL__DMAE0) | DMA0TSEL__UCA0RXIFG;
-        __data16_write_addr((unsigned short)(DMA_BASE + OFS_DMA0SA), (unsigned long)&UCA0RXBUF);
+    Pxx - CS (active low)
+    Pxx - SCLK
+    Pxx - MISO aka SOMI
+    Pxx - MOSI aka SIMO
 
-        DMACTL0 = (DMACTL0 & ~DMA1TSEL__DMAE0) | DMA1TSEL__UCA0TXIFG;
-        __data16_write_addr((unsigned short)(DMA_BASE + OFS_DMA1DA), (unsigned long)&UCA0TXBUF);
-    }
-#else
-    com_mode &= ~COM_MODE_DMA;
-#endif
+*/
 
-#endif // #if defined(DEFAULT_SPI)
+void spi_slave_initialize(const uint8_t mode, const uint8_t datamode, const uint8_t order)
+{
+    /*  Calling this dummy function prevents the linker
+        from stripping the USCI interupt vectors.*/
+    usci_isr_install();
 
+    /* Put USCI in reset mode, source USCI clock from SMCLK. */
+    UCzCTLW0 = UCSWRST;
 
+    /* SPI in slave MODE 0 - CPOL=0 SPHA=0. - 3 wire STE */
+    UCzCTLW0 |= UCSYNC;
 
+    UCzCTLW0 |= spi_slave_ctl_bits(mode, datamode, order);
+    spi_slave_setup(mode);
 
     /* Release USCI for operation. */
     UCzCTLW0 &= ~UCSWRST;
 }
 
 /**
-    spi_slave_disable() - put USCI into reset mode.
-*/
-void spi_slave_disable(void)
-{
-    /* Wait for previous tx to complete. */
-    while (UCzSTATW & UCBUSY);
-    /* Put USCI in reset mode. */
-    UCzCTLW0 |= UCSWRST;
-}
-
-/**
-    spi_slave_transfer() - send a bytes and recv response.
-*/
-
-void spi_slave_transfer(uint8_t *rxbuf, uint8_t *txbuf, uint16_t count)
-{
-    rxcount = count;
-    txcount = count;
-    rxrecived = 0;
-#ifdef __MSP430_HAS_DMA__
-    if (com_mode & COM_MODE_DMA)
-    {
-        HWREG16(DMA_BASE + OFS_DMA0CTL + dma_idx) = 0;
-        HWREG16(DMA_BASE + OFS_DMA1CTL + dma_idx) = 0;
-        /* Toggle USCI reset mode to flush TX pipe */
-        UCzCTLW0 |= UCSWRST;
-        UCzCTLW0 &= ~UCSWRST;
-        // RXIFG
-        __data16_write_addr((unsigned short)(DMA_BASE + OFS_DMA0DA + dma_idx), (unsigned long)rxbuf);
-        HWREG16(DMA_BASE + OFS_DMA0SZ  + dma_idx) = count;
-        HWREG16(DMA_BASE + OFS_DMA0CTL + dma_idx) = DMADT_0 + DMADSTINCR + DMASBDB + DMALEVEL + DMAEN;
-
-        //TXIFG;
-        __data16_write_addr((unsigned short)(DMA_BASE + OFS_DMA1SA + dma_idx), (unsigned long)txbuf);
-        HWREG16(DMA_BASE + OFS_DMA1SZ  + dma_idx) = count;
-        HWREG16(DMA_BASE + OFS_DMA1CTL + dma_idx) = DMADT_0 + DMASRCINCR + DMASBDB + DMALEVEL + DMAEN;
-    }
-    else
-#endif
-    {
-        rxptr = rxbuf;
-        txptr = txbuf;
-        com_mode &= ~COM_MODE_RX;
-        while ((UCzIFG & UCTXIFG) && txcount)
-        {
-            *(&(UCzTXBUF)) = *txptr++;  /* put in first character */
-            txcount--;
-        }
-        UCzIE |= UCRXIE;  /* need to receive data to transmit */
-    }
-}
+    spi_slave_reconfigure() - change wire mode, SPI mode and bit order.
 
-/**
-    spi_slave_receive() - send a bytes.
+    Only the mode fields of UCzCTLW0 are rewritten, under UCSWRST; DMA setup,
+    interrupt enables and pins are kept, so no full begin() is needed.
+    Call it between frames: the byte preloaded into UCzTXBUF is lost, arm
+    the next transfer afterwards. Returns 1 if the wire mode changed.
 */
-void spi_slave_receive(uint8_t *buf, uint16_t count)
-{
-    rxcount = count;
-    txcount = count;
-    rxrecived = 0;
-#ifdef __MSP430_HAS_DMA__
-    if (com_mode & COM_MODE_DMA)
-    {
-        HWREG16(DMA_BASE + OFS_DMA0CTL + dma_idx) = 0;
-        HWREG16(DMA_BASE + OFS_DMA1CTL + dma_idx) = 0;
-        /* Toggle USCI reset mode to flush TX pipe */
-        UCzCTLW0 |= UCSWRST;
-        UCzCTLW0 &= ~UCSWRST;
-        // RXIFG
-        __data16_write_addr((unsigned short)(DMA_BASE + OFS_DMA0DA + dma_idx), (unsigned long)buf);
-        HWREG16(DMA_BASE + OFS_DMA0SZ  + dma_idx) = count;
-        HWREG16(DMA_BASE + OFS_DMA0CTL + dma_idx) = DMADT_0 + DMADSTINCR + DMASBDB + DMALEVEL + DMAEN;
-
-        //TXIFG;
-        __data16_write_addr((unsigned short)(DMA_BASE + OFS_DMA1SA + dma_idx), (unsigned long)&dummy);
-        HWREG16(DMA_BASE + OFS_DMA1SZ  + dma_idx) = count;
-        HWREG16(DMA_BASE + OFS_DMA1CTL + dma_idx) = DMADT_0 + DMASBDB + DMALEVEL + DMAEN;
-    }
-    else
-#endif
-    {
-        rxptr = buf;
-        txptr = (uint8_t *) &dummy;
-        com_mode |= COM_MODE_RX;
-        while ((UCzIFG & UCTXIFG))
-        {
-            *(&(UCzTXBUF)) = dummy;  /* put in first characters */
-        }
-        UCzIE |= UCRXIE;  /* need to receive data to transmit */
-    }
-}
-
-int spi_bytes_to_transmit(void)
-{
-#ifdef __MSP430_HAS_DMA__
-    // when DMA enabled return DMAxSZ else done return 0
-    return ((HWREG16(DMA_BASE + OFS_DMA1CTL + dma_idx) & DMAEN) ? HWREG16(DMA_BASE + OFS_DMA1SZ + dma_idx) : 0);
-#else
-    return (txcount);
-#endif
-}
-
-
-int spi_bytes_received(void)
+uint8_t spi_slave_reconfigure(const uint8_t mode, const uint8_t datamode, const uint8_t order)
 {
-#ifdef __MSP430_HAS_DMA__
-    // when DMA enabled return DMAxSZ else done return 0
-    if (com_mode & COM_MODE_DMA)
+    uint16_t mask = UCMSB | UCMODE_3 | SPI_MODE_MASK;
+    uint16_t bits = spi_slave_ctl_bits(mode, datamode, order);
+    uint16_t ctl = UCzCTLW0;
+    uint8_t half = half_wire;
+    uint8_t ie;
+
+    half_wire = (mode == 3);
+    if ((ctl & mask) == bits)
     {
-        return ((HWREG16(DMA_BASE + OFS_DMA0CTL + dma_idx) & DMAEN) ? (rxcount - HWREG16(DMA_BASE + OFS_DMA0SZ + dma_idx)) : rxcount);
+        return (half != half_wire);
     }
-    else
-    {
-        return (rxrecived);
-    }
-#else
-    return (rxrecived);
-#endif
+    ie = UCzIE;
+    UCzCTLW0 = ctl | UCSWRST;
+    UCzCTLW0 = (ctl & ~mask) | bits | UCSWRST;
+    UCzCTLW0 &= ~UCSWRST;
+    UCzIE = ie;  /* UCSWRST clears the interrupt enables */
+    return ((((ctl ^ bits) & UCMODE_3) != 0) || (half != half_wire));
 }
 
 
-int spi_data_done(void)
-{
-#ifdef __MSP430_HAS_DMA__
-    return (!(HWREG16(DMA_BASE + OFS_DMA0CTL + dma_idx) & DMAEN));
-#else
-    return (rxcount == 0);
 #endif
-}
-
-
-void spi_rx_isr(uint8_t offset)
-{
-    uint8_t temp;
-    temp = *txptr; // store in case tx and rx ptr are identical
-    if (rxcount)
-    {
-        if (rxptr != 0)
-        {
-            *rxptr++ = *(&(UCzRXBUF));
-            rxcount--;
-            rxrecived++;
-        }
-    }
-    else
-    {
-        UCzIE &= ~UCRXIE;  /* disable interrupt */
-    }
-    if (txcount)
-    {
-        if (txptr != 0)
-        {
-            *(&(UCzTXBUF)) = temp;
-            if ((com_mode & COM_MODE_RX) == 0)
-            {
-                *txptr++;
-            }
-            txcount--;
-        }
-    }
-
-}
-
-
-#endif // #if defined(DEFAULT_SPI)
-
@@ -0,0 +1,66 @@
+/*
+    eusci_spi_slave.h - register access of the msp430 eUSCI SPI Slave implementation
+
+    EUSCI flavor implementation by StefanSch
+    based on:
+    Copyright (c) 2012 by Rick Kimball <rick@kimballsoftware.com>
+    spi slave abstraction api for msp430
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+    Internal to the library, included through spi_slave_common.h.
+
+*/
+
+#ifndef _EUSCI_SPI_SLAVE_H_
+#define _EUSCI_SPI_SLAVE_H_
+
+#if defined(__MSP430_HAS_EUSCI_B0__)
+#define UCB0_BASE __MSP430_BASEADDRESS_EUSCI_B0__
+#endif
+#if defined(__MSP430_HAS_EUSCI_B1__)
+#define UCB1_BASE __MSP430_BASEADDRESS_EUSCI_B1__
+#endif
+#if defined(__MSP430_HAS_EUSCI_B2__)
+#define UCB2_BASE __MSP430_BASEADDRESS_EUSCI_B2__
+#endif
+#if defined(__MSP430_HAS_EUSCI_B3__)
+#define UCB3_BASE __MSP430_BASEADDRESS_EUSCI_B3__
+#endif
+
+#if defined(__MSP430_HAS_EUSCI_A0__)
+#define UCA0_BASE __MSP430_BASEADDRESS_EUSCI_A0__
+#endif
+#if defined(__MSP430_HAS_EUSCI_A1__)
+#define UCA1_BASE __MSP430_BASEADDRESS_EUSCI_A1__
+#endif
+#if defined(__MSP430_HAS_EUSCI_A2__)
+#define UCA2_BASE __MSP430_BASEADDRESS_EUSCI_A2__
+#endif
+#if defined(__MSP430_HAS_EUSCI_A3__)
+#define UCA3_BASE __MSP430_BASEADDRESS_EUSCI_A3__
+#endif
+
+/* eUSCI_Ax and eUSCI_Bx differ in the offsets of STATW, IFG and IE */
+#define UCzCTLW0     HWREG16(OFS_UCBxCTLW0 + SPI_slave_baseAddress)
+#define UCzCTL0      HWREG8(OFS_UCBxCTL0   + SPI_slave_baseAddress)
+#define UCzCTL1      HWREG8(OFS_UCBxCTL1   + SPI_slave_baseAddress)
+#define UCzBRW       HWREG16(OFS_UCBxBRW   + SPI_slave_baseAddress)
+#define UCzBR0       HWREG8(OFS_UCBxBR0    + SPI_slave_baseAddress)
+#define UCzBR1       HWREG8(OFS_UCBxBR1    + SPI_slave_baseAddress)
+#define UCzSTATW     HWREG8(((spiSlaveModule < 10) ? OFS_UCBxSTATW : OFS_UCAxSTATW) + SPI_slave_baseAddress)
+#define OFS_UCzRXBUF OFS_UCBxRXBUF
+#define OFS_UCzTXBUF OFS_UCBxTXBUF
+#define UCzTXBUF     HWREG8(OFS_UCzTXBUF   + SPI_slave_baseAddress)
+#define UCzRXBUF     HWREG8(OFS_UCzRXBUF   + SPI_slave_baseAddress)
+#define UCzIFG       HWREG8(((spiSlaveModule < 10) ? OFS_UCBxIFG : OFS_UCAxIFG) + SPI_slave_baseAddress)
+#define UCzIE        HWREG8(((spiSlaveModule < 10) ? OFS_UCBxIE : OFS_UCAxIE) + SPI_slave_baseAddress)
+
+/* names shared with the USCI backend */
+#define UCzSTAT      UCzSTATW
+#define UCzSWRST     UCzCTLW0    /* register holding UCSWRST */
+
+#endif /*_EUSCI_SPI_SLAVE_H_*/
@@ -16,6 +16,8 @@
 #ifndef _SPI_SLAVE_430_H_
 #define _SPI_SLAVE_430_H_
 
+#include "spi_slave_config.h"
+
 #if defined(__MSP430_HAS_USCI_B0__) || defined(__MSP430_HAS_USCI_B1__) || defined(__MSP430_HAS_USCI__) || defined(__MSP430_HAS_EUSCI_B0__) || defined(__MSP430_HAS_EUSCI_B1__) || defined(DEFAULT_SPI)
 
 #elif defined(__MSP430_HAS_USI__)
@@ -30,11 +32,45 @@ extern uint8_t spiSlaveModule;
 
 void spi_slave_initialize(const uint8_t, const uint8_t, const uint8_t order);
 void spi_slave_disable(void);
+uint16_t spi_slave_abort(void);
+uint16_t spi_slave_close(void);
+uint8_t spi_slave_reconfigure(const uint8_t mode, const uint8_t datamode, const uint8_t order);
 void spi_slave_transfer(uint8_t *rxbuf, uint8_t *txbuf, uint16_t count);
 void spi_slave_receive(uint8_t *buf, uint16_t count);
+void spi_slave_probe(uint8_t *buf, uint16_t count);
+uint8_t spi_slave_rearm(void);
+void spi_slave_set_frame_timer(uint8_t on);
+uint8_t spi_slave_frame_started(uint32_t *ms);
+void spi_slave_echo(uint8_t xor_mask, uint8_t increment);
+#if SPI_SLAVE_STREAM
+void spi_slave_stream(uint8_t *buf, uint16_t size);
+uint32_t spi_slave_stream_count(void);
+#endif
+#if SPI_SLAVE_HALF_DUPLEX
+void spi_slave_half_duplex(uint8_t *rxbuf, uint16_t rx, uint8_t *txbuf, uint16_t tx);
+void spi_slave_set_data_pin(uint8_t pin, uint16_t pin_mode);
+void spi_slave_set_turn_hook(uint16_t (*hook)(uint8_t *command));
+#endif
+void spi_slave_set_header_hook(uint16_t header, uint16_t (*hook)(uint8_t *header));
+void spi_slave_set_done_hook(void (*hook)(uint16_t received));
+void spi_slave_set_ready_pin(uint8_t pin, uint8_t active_level);
+void spi_slave_set_status_hook(uint8_t (*hook)(void));
 int spi_data_done(void);
+int spi_slave_uses_dma(void);
+#if !SPI_SLAVE_DMA_VECTOR
+void spi_slave_dma_handler(void);
+#endif
 int spi_bytes_to_transmit(void);
 int spi_bytes_received(void);
+void spi_rx_isr(uint8_t offset);
+#if SPI_SLAVE_ERRORS
+uint16_t spi_slave_errors(void);
+#endif
+
+/* DMA block transfers of SPIMasterBlock */
+uint8_t spi_master_block_begin(uint8_t module);
+void spi_master_block_start(uint8_t *rxbuf, const uint8_t *txbuf, uint16_t count);
+int spi_master_block_busy(void);
 
 
 #endif /*_SPI_SLAVE_430_H_*/
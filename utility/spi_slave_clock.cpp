@@ -0,0 +1,155 @@
+/*
+    spi_slave_clock.cpp - MCLK scaling for the SPI Slave implementations
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+*/
+
+#include <msp430.h>
+#include <stdint.h>
+#include <Energia.h>
+#include "spi_slave_clock.h"
+
+#if defined(__MSP430_HAS_CS__) && defined(CSKEY)
+/* FR5xx/FR6xx/FR57xx: CSCTL3 DIVM, the CS registers are password protected */
+#define MCLK_DIV_REG    CSCTL3
+#define MCLK_DIV_POS    0
+#define MCLK_DIV_MASK   (DIVM0 | DIVM1 | DIVM2)
+#define MCLK_DIV_MAX    5
+#define MCLK_UNLOCK()   (CSCTL0_H = (CSKEY >> 8))
+#define MCLK_LOCK()     (CSCTL0_H = 0)
+#elif defined(__MSP430_HAS_CS__)
+/* FR2xx/FR4xx: CSCTL5 DIVM, SMCLK = MCLK / DIVS is held by lowering DIVS */
+#define MCLK_DIV_REG    CSCTL5
+#define MCLK_DIV_POS    0
+#define MCLK_DIV_MASK   (DIVM0 | DIVM1 | DIVM2)
+#define MCLK_DIV_MAX    7
+#define SMCLK_DIV_POS   4
+#define SMCLK_DIV_MASK  (DIVS0 | DIVS1)
+#define SMCLK_DIV_MAX   3
+#elif defined(__MSP430_HAS_UCS__)
+/* F5xx/F6xx: UCSCTL5 DIVM */
+#define MCLK_DIV_REG    UCSCTL5
+#define MCLK_DIV_POS    0
+#define MCLK_DIV_MASK   (DIVM0 | DIVM1 | DIVM2)
+#define MCLK_DIV_MAX    5
+#elif defined(__MSP430_HAS_BC2__)
+/* F2xx/G2xx: BCSCTL2 DIVM */
+#define MCLK_DIV_REG    BCSCTL2
+#define MCLK_DIV_POS    4
+#define MCLK_DIV_MASK   (DIVM0 | DIVM1)
+#define MCLK_DIV_MAX    3
+#else
+#define MCLK_DIV_MAX    0
+#endif
+
+#ifndef MCLK_UNLOCK
+#define MCLK_UNLOCK()
+#define MCLK_LOCK()
+#endif
+
+#ifdef SMCLK_DIV_MASK
+/* DIVM + DIVS, the SMCLK divider from the DCO; kept constant */
+static uint8_t spi_slave_smclk_shift(void)
+{
+    return (((MCLK_DIV_REG & MCLK_DIV_MASK) >> MCLK_DIV_POS) + ((MCLK_DIV_REG & SMCLK_DIV_MASK) >> SMCLK_DIV_POS));
+}
+#endif
+
+/**
+    spi_slave_mclk_divider() - MCLK = F_CPU >> the returned value.
+*/
+uint8_t spi_slave_mclk_divider(void)
+{
+#if MCLK_DIV_MAX
+    return ((MCLK_DIV_REG & MCLK_DIV_MASK) >> MCLK_DIV_POS);
+#else
+    return (0);
+#endif
+}
+
+/**
+    spi_slave_mclk_max_divider() - largest shift the clock system supports.
+
+    On FR2xx/FR4xx that is the shift of SMCLK from the DCO, see spi_slave_clock.h.
+*/
+uint8_t spi_slave_mclk_max_divider(void)
+{
+#ifdef SMCLK_DIV_MASK
+    uint8_t smclk = spi_slave_smclk_shift();
+
+    return ((smclk < MCLK_DIV_MAX) ? smclk : MCLK_DIV_MAX);
+#else
+    return (MCLK_DIV_MAX);
+#endif
+}
+
+/**
+    spi_slave_mclk_set_divider() - run MCLK at F_CPU >> shift.
+
+    shift is limited to what the clock system supports, the shift set is
+    returned; on FR2xx/FR4xx DIVS moves the other way so SMCLK stays.
+    Call it between frames, the CPU slows down at once.
+*/
+uint8_t spi_slave_mclk_set_divider(uint8_t shift)
+{
+    uint8_t max = spi_slave_mclk_max_divider();
+#ifdef SMCLK_DIV_MASK
+    uint8_t smclk = spi_slave_smclk_shift();
+#endif
+
+    if (shift > max)
+    {
+        shift = max;
+    }
+#ifdef SMCLK_DIV_MASK
+    if ((smclk - shift) > SMCLK_DIV_MAX)
+    {
+        /* DIVS would have to go beyond /8, SMCLK cannot be held */
+        return (spi_slave_mclk_divider());
+    }
+    MCLK_DIV_REG = (MCLK_DIV_REG & ~(MCLK_DIV_MASK | SMCLK_DIV_MASK))
+            | ((uint16_t)shift << MCLK_DIV_POS) | ((uint16_t)(smclk - shift) << SMCLK_DIV_POS);
+#elif MCLK_DIV_MAX
+    MCLK_UNLOCK();
+    MCLK_DIV_REG = (MCLK_DIV_REG & ~MCLK_DIV_MASK) | ((uint16_t)shift << MCLK_DIV_POS);
+    MCLK_LOCK();
+#endif
+    return (shift);
+}
+
+/**
+    spi_slave_mclk_required() - MCLK in Hz that sustains sck_hz and frames_per_s.
+
+    The byte part is a latency bound: the RX interrupt has to finish
+    within one byte time or the next byte overruns it. With DMA the bytes
+    only steal a few cycles and the re-arm per frame dominates.
+*/
+uint32_t spi_slave_mclk_required(uint32_t sck_hz, uint32_t frames_per_s, uint8_t dma)
+{
+    uint32_t per_byte = (sck_hz / 8) * (dma ? SPI_SLAVE_CYCLES_DMA_BYTE : SPI_SLAVE_CYCLES_BYTE);
+    uint32_t per_frame = frames_per_s * SPI_SLAVE_CYCLES_FRAME;
+
+    return ((per_byte + per_frame) * SPI_SLAVE_CLOCK_HEADROOM);
+}
+
+/**
+    spi_slave_mclk_scale() - set the largest divider that still meets spi_slave_mclk_required().
+
+    Returns the shift set, 0 if MCLK cannot be lowered.
+*/
+uint8_t spi_slave_mclk_scale(uint32_t sck_hz, uint32_t frames_per_s, uint8_t dma)
+{
+    uint32_t required = spi_slave_mclk_required(sck_hz, frames_per_s, dma);
+    uint8_t max = spi_slave_mclk_max_divider();
+    uint8_t shift = 0;
+
+    while ((shift < max) && ((F_CPU >> (shift + 1)) >= required))
+    {
+        shift++;
+    }
+    return (spi_slave_mclk_set_divider(shift));
+}
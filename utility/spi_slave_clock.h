@@ -0,0 +1,57 @@
+/*
+    spi_slave_clock.h - MCLK scaling for the SPI Slave implementations
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+    The slave is clocked by the master, MCLK only has to be fast enough
+    for the RX interrupt (or the DMA) to keep up with SCK and for the
+    re-arm between frames. These functions divide MCLK down from F_CPU
+    with the DIVM field of the clock system (CS, UCS or BCS+). SMCLK and
+    ACLK are not touched, so timers, millis() and UART baud rates stay
+    correct; busy waits calibrated on F_CPU, like delayMicroseconds(),
+    run slower by the divider.
+
+    On FR2xx/FR4xx SMCLK is MCLK divided by DIVS. There DIVS is lowered
+    by what DIVM is raised, so MCLK can only be divided as far as SMCLK
+    already is (DIVS at most /8); with SMCLK = MCLK the divider stays 0.
+
+    The cycle figures below come from the timing model in
+    spi_slave_timing.h. Run the SPI_Energy_Benchmark example to find the
+    real limit of a setup and override them, or set the divider directly.
+
+*/
+
+#ifndef _SPI_SLAVE_CLOCK_H_
+#define _SPI_SLAVE_CLOCK_H_
+
+#include <stdint.h>
+#include "spi_slave_config.h"
+#include "spi_slave_timing.h"
+
+/* MCLK cycles per byte in interrupt mode: entry, dispatch, store, return */
+#ifndef SPI_SLAVE_CYCLES_BYTE
+#define SPI_SLAVE_CYCLES_BYTE     (SPI_TIMING_IRQ + SPI_TIMING_DISPATCH + SPI_TIMING_RX_BYTE)
+#endif
+/* MCLK cycles per byte in DMA mode: one RX and one TX transfer */
+#ifndef SPI_SLAVE_CYCLES_DMA_BYTE
+#define SPI_SLAVE_CYCLES_DMA_BYTE (SPI_TIMING_DMA_BYTE + SPI_TIMING_DMA_WAIT)
+#endif
+/* MCLK cycles per frame: completion interrupt, done hook and re-arm */
+#ifndef SPI_SLAVE_CYCLES_FRAME
+#define SPI_SLAVE_CYCLES_FRAME    (SPI_TIMING_IRQ + SPI_TIMING_DMA_ISR + SPI_TIMING_COMPLETE + SPI_TIMING_ARM_DMA)
+#endif
+/* required MCLK is multiplied by this before a divider is chosen */
+#ifndef SPI_SLAVE_CLOCK_HEADROOM
+#define SPI_SLAVE_CLOCK_HEADROOM  2
+#endif
+
+uint8_t spi_slave_mclk_divider(void);
+uint8_t spi_slave_mclk_set_divider(uint8_t shift);
+uint8_t spi_slave_mclk_max_divider(void);
+uint32_t spi_slave_mclk_required(uint32_t sck_hz, uint32_t frames_per_s, uint8_t dma);
+uint8_t spi_slave_mclk_scale(uint32_t sck_hz, uint32_t frames_per_s, uint8_t dma);
+
+#endif /*_SPI_SLAVE_CLOCK_H_*/
@@ -0,0 +1,1406 @@
+/**
+    File: spi_slave_common.cpp - msp430 USCI and eUSCI SPI Slave implementation
+
+    spi slave implementation by StefanSch
+    based on:
+    Copyright (c) 2012 by Rick Kimball <rick@kimballsoftware.com>
+    spi slave abstraction api for msp430
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+    Shared by both module families, the registers are reached through the
+    UCz macros of usci_spi_slave.h or eusci_spi_slave.h.
+
+*/
+
+#include <msp430.h>
+#include <stdint.h>
+#include "spi_slave_common.h"
+#include "spi_slave_trace.h"
+#include "spi_slave_stats.h"
+#include <Energia.h>
+
+#if SPI_SLAVE_UCX
+
+uint8_t * rxptr;
+uint8_t * txptr;
+uint16_t rxcount = 0;
+uint16_t txcount = 0;
+uint16_t rxrecived = 0;
+uint8_t com_mode = 0; /* mode : 0 - RX and TX  1 - RX only, TX to dummy */
+#define COM_MODE_RX  0x1
+#define COM_MODE_DMA 0x2
+#if SPI_SLAVE_ECHO
+#define COM_MODE_ECHO 0x4
+#else
+#define COM_MODE_ECHO 0   /* echo tests fold away */
+#endif
+#if SPI_SLAVE_HOOKS
+#define COM_MODE_HEADER 0x8 /* header of the current transfer not yet passed to the header hook */
+#else
+#define COM_MODE_HEADER 0
+#endif
+#if SPI_SLAVE_STREAM
+#define COM_MODE_STREAM 0x10 /* stream(): endless receive into a ring */
+#else
+#define COM_MODE_STREAM 0
+#endif
+#if SPI_SLAVE_HALF_DUPLEX
+#define COM_MODE_HALF 0x20 /* halfDuplex() command phase, the turnaround follows */
+#define COM_MODE_TURN 0x40 /* halfDuplex() response phase, the data pin drives */
+#else
+#define COM_MODE_HALF 0
+#define COM_MODE_TURN 0
+#endif
+
+#if SPI_SLAVE_DIRECTION == SPI_SLAVE_RX_ONLY
+#define SPI_TX_STEP 0     /* TX pointer stays on the dummy byte */
+#else
+#define SPI_TX_STEP ((com_mode & COM_MODE_RX) == 0)
+#endif
+
+uint8_t echo_xor = 0; /* echo mode: byte sent back = (received ^ echo_xor) + echo_add */
+uint8_t echo_add = 0;
+
+uint8_t * stream_end;          /* stream mode: rxptr wraps to rxstart here */
+uint16_t stream_size = 0;
+volatile uint32_t stream_laps = 0; /* completed passes over the ring */
+
+uint8_t half_wire = 0;         /* MODE_3WIRE_HALF, one data line */
+#if SPI_SLAVE_HALF_DUPLEX
+volatile uint8_t * data_dir = 0; /* PxDIR of the SOMI pin on the data line, 0 if it is not switched */
+volatile uint8_t * data_sel0;  /* PxSEL/PxSEL0 */
+volatile uint8_t * data_sel1;  /* PxSEL1/PxSEL2, data_sel0 if there is none */
+uint8_t data_mask = 0;
+uint8_t data_on0 = 0;          /* bits of its SOMI function */
+uint8_t data_on1 = 0;
+uint8_t data_out = 0;
+uint8_t * half_txbuf;          /* response, sent after the turnaround */
+uint16_t half_tx = 0;
+uint16_t half_rx = 0;          /* command length, reported from the turnaround on */
+#if SPI_SLAVE_HOOKS
+uint16_t (*turn_hook)(uint8_t *command) = 0;
+#else
+#define turn_hook ((uint16_t (*)(uint8_t *))0)
+#endif
+#endif
+
+uint8_t dma_idx = 0; /* index to DMA channel */
+static uint8_t slave_setup = 0; /* spi_slave_setup() ran, spiSlaveModule is the slave's */
+static uint8_t quiet = 0; /* armed by spi_slave_probe(): not a frame, not traced or counted */
+
+#define ARM_NONE     0     /* echo, stream or half-duplex, not re-armed */
+#define ARM_TRANSFER 1
+#define ARM_RECEIVE  2
+#define ARM_PROBE    3
+static uint8_t arm_kind = ARM_NONE;  /* last armed transfer, see spi_slave_rearm() */
+static uint8_t * arm_rx;
+static uint8_t * arm_tx;
+static uint16_t arm_count;
+
+static uint8_t frame_timer = 0;      /* time the first byte of each frame */
+static volatile uint8_t frame_begun = 0;
+static volatile uint32_t frame_ms;   /* millis() at the first byte */
+
+uint8_t * rxstart;    /* start of the current receive buffer */
+uint16_t header_len = 0;
+#if SPI_SLAVE_HOOKS
+uint16_t (*header_hook)(uint8_t *header) = 0;
+void (*done_hook)(uint16_t received) = 0;
+uint8_t (*status_hook)(void) = 0;
+#else
+/* constant null hooks, the compiler drops every branch using them */
+#define header_hook ((uint16_t (*)(uint8_t *))0)
+#define done_hook   ((void (*)(uint16_t))0)
+#define status_hook ((uint8_t (*)(void))0)
+#endif
+
+volatile uint8_t * ready_out = 0; /* ready/busy output, 0 if not used */
+uint8_t ready_mask = 0;
+uint8_t ready_level = HIGH;
+
+/* completion must be signalled by interrupt, also in DMA mode */
+#define SPI_EVENTS (header_hook || done_hook || ready_out || SPI_SLAVE_TRACE || SPI_SLAVE_STATS)
+
+const uint8_t dummy = 0xFF;
+uint8_t rx_sink;  /* RX DMA destination, received bytes are dropped */
+#if SPI_SLAVE_ERRORS
+volatile uint16_t overruns = 0;
+#endif
+
+const spi_slave_module_t *spi_slave_find_module(uint16_t base)
+{
+    uint8_t i;
+    for (i = 0; i < spi_slave_module_count; i++)
+    {
+        if (spi_slave_modules[i].base == base)
+        {
+            return (&spi_slave_modules[i]);
+        }
+    }
+    return (0);
+}
+
+#if SPI_SLAVE_DMA
+/**
+    spi_slave_dma_trigger() - program the trigger select field of one DMA channel.
+
+    DMAX packs two 5 bit fields into each DMACTLx, the F2xx DMA three 4 bit
+    fields into DMACTL0; trigger is the raw trigger number.
+*/
+void spi_slave_dma_trigger(uint8_t chan, uint8_t trigger)
+{
+    volatile uint16_t *ctl = &HWREG16(SPI_DMA_TSEL_REG(chan));
+    uint8_t shift = SPI_DMA_TSEL_SHIFT(chan);
+
+    *ctl = (*ctl & ~((uint16_t)SPI_DMA_TSEL_MASK << shift)) | ((uint16_t)(trigger & SPI_DMA_TSEL_MASK) << shift);
+}
+#endif
+
+/**
+    spi_slave_ready() - drive the ready/busy output to the armed (1) or idle (0) state.
+*/
+static void spi_slave_ready(uint8_t armed)
+{
+    if (ready_out)
+    {
+        if ((armed != 0) == (ready_level == HIGH))
+        {
+            *ready_out |= ready_mask;
+        }
+        else
+        {
+            *ready_out &= ~ready_mask;
+        }
+    }
+}
+
+/**
+    spi_slave_prime() - defined start of a frame.
+
+    The reset flushes whatever is left in TXBUF and the shift register from
+    the previous frame, then the first byte is written by the CPU so it is
+    in place before the first SCK edge, independent of DMA trigger latency.
+    With a status hook its byte replaces first. Returns 1 if the status byte
+    was sent, i.e. first was not consumed.
+*/
+static uint8_t spi_slave_prime(uint8_t first)
+{
+    UCzSWRST |= UCSWRST;
+    UCzSWRST &= ~UCSWRST;
+    if (status_hook)
+    {
+        *(&(UCzTXBUF)) = status_hook();
+        return (1);
+    }
+    *(&(UCzTXBUF)) = first;
+    return (0);
+}
+
+/**
+    spi_slave_complete() - end of the armed transfer, called in interrupt context.
+*/
+static void spi_slave_complete(uint16_t received)
+{
+    spi_slave_ready(0);
+    if (!quiet)
+    {
+        SPI_TRACE_END(received, rxstart, SPI_TRACE_DONE);
+        SPI_STATS_END(received);
+    }
+    if (done_hook)
+    {
+        done_hook(received);
+    }
+}
+
+#if SPI_SLAVE_HALF_DUPLEX
+/**
+    spi_slave_half_stop() - leave half-duplex, the data pin goes back to input.
+*/
+static void spi_slave_half_stop(void)
+{
+    if ((com_mode & COM_MODE_TURN) && data_dir)
+    {
+        *data_sel0 &= ~data_mask;
+        *data_sel1 &= ~data_mask;
+        *data_dir &= ~data_mask;
+    }
+    com_mode &= ~(COM_MODE_HALF | COM_MODE_TURN);
+}
+
+/**
+    spi_slave_half_end() - response clocked out, the master owns the line again.
+*/
+static void spi_slave_half_end(void)
+{
+    spi_slave_half_stop();
+    spi_slave_complete(half_rx);
+}
+
+/**
+    spi_slave_turn() - command received, turn the data line around.
+
+    Called in interrupt context after the last command byte. The turn hook
+    may fill and shorten the response, then the TX pipe is primed as at
+    the start of a frame and only then the data pin starts to drive, so
+    the line shows the first response bit at once. The master has to keep
+    SCK idle for this long (turn_ns of spi_slave_timing.h).
+*/
+static void spi_slave_turn(void)
+{
+    uint8_t *txbuf = half_txbuf;
+    uint16_t count = half_tx;
+    uint16_t size;
+
+    com_mode = (com_mode & ~COM_MODE_HALF) | COM_MODE_TURN;
+    if (turn_hook)
+    {
+        size = turn_hook(rxstart);
+        if (size < count)
+        {
+            count = size;
+        }
+    }
+    if (count == 0)
+    {
+        spi_slave_half_end();
+        return;
+    }
+#if SPI_SLAVE_DMA
+    if (com_mode & COM_MODE_DMA)
+    {
+        if (spi_slave_prime(*txbuf) == 0)
+        {
+            txbuf++;
+        }
+        /* RXIFG: the response read back over SIMO, dropped; its end is the end of the frame */
+        __data16_write_addr((unsigned short)SPI_DMA_RX(dma_idx, SPI_DMA_DA), (unsigned long)&rx_sink);
+        HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_SZ)) = count;
+        HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_CTL)) = DMADT_0 + DMASBDB + DMALEVEL + DMAIE + DMAEN;
+        if (count > 1)
+        {
+            __data16_write_addr((unsigned short)SPI_DMA_TX(dma_idx, SPI_DMA_SA), (unsigned long)txbuf);
+            HWREG16(SPI_DMA_TX(dma_idx, SPI_DMA_SZ)) = count - 1;
+            HWREG16(SPI_DMA_TX(dma_idx, SPI_DMA_CTL)) = DMADT_0 + DMASRCINCR + DMASBDB + DMALEVEL + DMAEN;
+        }
+    }
+    else
+#endif
+    {
+        rxptr = 0;
+        rxcount = count;
+        txptr = txbuf;
+        txcount = count;
+        if (spi_slave_prime(*txptr) == 0)
+        {
+            txptr++;
+        }
+        txcount--;
+        while ((UCzIFG & UCTXIFG) && txcount)
+        {
+            *(&(UCzTXBUF)) = *txptr++;
+            txcount--;
+        }
+        UCzIE |= UCRXIE;
+    }
+    if (data_dir)
+    {
+        *data_sel0 |= data_on0;
+        *data_sel1 |= data_on1;
+        *data_dir |= data_out;
+    }
+}
+#else
+#define spi_slave_half_stop()
+#endif
+
+#if SPI_SLAVE_DMA
+/*
+    Arm the RX channel. With a header hook only the header is received first,
+    the DMA interrupt then sizes the rest of the frame.
+*/
+static void spi_slave_dma_rx(uint8_t *buf, uint16_t count)
+{
+    rxstart = buf;
+#if SPI_SLAVE_DIRECTION == SPI_SLAVE_TX_ONLY
+    buf = 0;
+#endif
+    if ((buf != 0) && header_hook && (header_len < count))
+    {
+        com_mode |= COM_MODE_HEADER;
+        count = header_len;
+    }
+    if (buf == 0)
+    {
+        /* received bytes are dropped */
+        __data16_write_addr((unsigned short)SPI_DMA_RX(dma_idx, SPI_DMA_DA), (unsigned long)&rx_sink);
+        HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_SZ)) = count;
+        HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_CTL)) = DMADT_0 + DMASBDB + DMALEVEL + DMAEN
+                + (SPI_EVENTS ? DMAIE : 0);
+        return;
+    }
+    __data16_write_addr((unsigned short)SPI_DMA_RX(dma_idx, SPI_DMA_DA), (unsigned long)buf);
+    HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_SZ)) = count;
+    HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_CTL)) = DMADT_0 + DMADSTINCR + DMASBDB + DMALEVEL + DMAEN
+            + (SPI_EVENTS ? DMAIE : 0);
+}
+#endif
+
+/**
+    spi_slave_setup() - family independent part of spi_slave_initialize().
+
+    Called with the module held in reset: records the wire mode and routes
+    the RX/TX flags of the selected module to its DMA channel pair.
+*/
+void spi_slave_setup(const uint8_t mode)
+{
+    half_wire = (mode == 3);
+    slave_setup = 1;
+#if SPI_SLAVE_DMA
+    const spi_slave_module_t *m = spi_slave_find_module(SPI_slave_baseAddress);
+    com_mode = COM_MODE_DMA;
+    if ((m != 0) && (m->dma_chan != SPI_DMA_NONE))
+    {
+        dma_idx = m->dma_chan * SPI_DMA_STRIDE;
+        spi_slave_dma_trigger(m->dma_chan, m->rx_trigger);
+        __data16_write_addr((unsigned short)SPI_DMA_RX(dma_idx, SPI_DMA_SA), (unsigned long)m->rxbuf);
+
+        spi_slave_dma_trigger(m->dma_chan + 1, m->tx_trigger);
+        __data16_write_addr((unsigned short)SPI_DMA_TX(dma_idx, SPI_DMA_DA), (unsigned long)m->txbuf);
+    }
+    else
+    {
+        com_mode &= ~COM_MODE_DMA;
+    }
+#else
+    com_mode = 0;
+#endif
+}
+
+/**
+    spi_slave_disable() - put USCI into reset mode.
+*/
+void spi_slave_disable(void)
+{
+    /* Wait for previous tx to complete. */
+    while (UCzSTAT & UCBUSY);
+    /* Put USCI in reset mode. */
+    UCzSWRST |= UCSWRST;
+    spi_slave_ready(0);
+#if SPI_SLAVE_DMA
+    if (com_mode & (COM_MODE_ECHO | COM_MODE_STREAM | COM_MODE_HALF | COM_MODE_TURN))
+    {
+        HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_CTL)) = 0;
+        HWREG16(SPI_DMA_TX(dma_idx, SPI_DMA_CTL)) = 0;
+    }
+#endif
+    spi_slave_half_stop();
+    com_mode &= ~(COM_MODE_ECHO | COM_MODE_STREAM);
+}
+
+/**
+    spi_slave_stop() - stop the transfer in progress, common part of abort and close.
+*/
+static void spi_slave_stop(void)
+{
+    UCzIE &= ~UCRXIE;
+#if SPI_SLAVE_DMA
+    if (com_mode & COM_MODE_DMA)
+    {
+        HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_CTL)) = 0;
+        HWREG16(SPI_DMA_TX(dma_idx, SPI_DMA_CTL)) = 0;
+    }
+#endif
+    UCzSWRST |= UCSWRST;
+    UCzSWRST &= ~UCSWRST;
+    spi_slave_half_stop();
+    com_mode &= ~(COM_MODE_ECHO | COM_MODE_HEADER | COM_MODE_STREAM);
+    rxcount = 0;
+    txcount = 0;
+    quiet = 0;
+    frame_begun = 0;
+    spi_slave_ready(0);
+}
+
+/**
+    spi_slave_abort() - drop the transfer in progress.
+
+    Stops the DMA channels and the RX interrupt and resets the module, so a frame cut short by the
+    master leaves nothing behind in the shift register. Returns the
+    number of bytes received before the abort.
+*/
+uint16_t spi_slave_abort(void)
+{
+    uint16_t received = spi_bytes_received();
+
+    if (!quiet)
+    {
+        SPI_TRACE_END(received, rxstart, SPI_TRACE_ABORT);
+        SPI_STATS_ABORT();
+    }
+    spi_slave_stop();
+    return (received);
+}
+
+/**
+    spi_slave_close() - end the transfer in progress at the end of its frame.
+
+    For frames delimited by CS rather than by the byte count: tears down
+    like spi_slave_abort(), but the frame is traced and counted as
+    completed, not as aborted. A transfer that already completed is not
+    reported twice, one the master never started is not reported at all.
+    Returns the number of bytes received.
+*/
+uint16_t spi_slave_close(void)
+{
+    uint16_t received = spi_bytes_received();
+
+    if (!quiet && (received != 0) && !spi_data_done())
+    {
+        SPI_TRACE_END(received, rxstart, SPI_TRACE_DONE);
+        SPI_STATS_CLOSE(received);
+    }
+    spi_slave_stop();
+    return (received);
+}
+
+/**
+    spi_slave_transfer() - send a bytes and recv response.
+
+    rxbuf may be 0, the received bytes are then dropped.
+*/
+
+void spi_slave_transfer(uint8_t *rxbuf, uint8_t *txbuf, uint16_t count)
+{
+#if SPI_SLAVE_DIRECTION == SPI_SLAVE_RX_ONLY
+    (void)txbuf;
+    spi_slave_receive(rxbuf, count);
+    return;
+#endif
+    spi_slave_half_stop();
+    com_mode &= ~(COM_MODE_ECHO | COM_MODE_HEADER | COM_MODE_STREAM);
+    spi_slave_ready(0);
+    rxcount = count;
+    txcount = count;
+    rxrecived = 0;
+    quiet = 0;
+    frame_begun = 0;
+    arm_kind = ARM_TRANSFER;
+    arm_rx = rxbuf;
+    arm_tx = txbuf;
+    arm_count = count;
+    SPI_TRACE_START(count, ((com_mode & COM_MODE_DMA) ? SPI_TRACE_DMA : 0) | ((header_hook && (header_len < count)) ? SPI_TRACE_HEADER : 0));
+    SPI_STATS_ARM();
+#if SPI_SLAVE_DMA
+    if (com_mode & COM_MODE_DMA)
+    {
+        HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_CTL)) = 0;
+        HWREG16(SPI_DMA_TX(dma_idx, SPI_DMA_CTL)) = 0;
+        rxstart = rxbuf;
+        if (count)  /* DMAxSZ = 0 would never complete */
+        {
+            /* Flush TX pipe and load the first byte */
+            if (spi_slave_prime(*txbuf) == 0)
+            {
+                txbuf++;
+            }
+            // RXIFG
+            spi_slave_dma_rx(rxbuf, count);
+
+            //TXIFG;
+            if (count > 1)
+            {
+                __data16_write_addr((unsigned short)SPI_DMA_TX(dma_idx, SPI_DMA_SA), (unsigned long)txbuf);
+                HWREG16(SPI_DMA_TX(dma_idx, SPI_DMA_SZ)) = count - 1;
+                HWREG16(SPI_DMA_TX(dma_idx, SPI_DMA_CTL)) = DMADT_0 + DMASRCINCR + DMASBDB + DMALEVEL + DMAEN;
+            }
+        }
+    }
+    else
+#endif
+    {
+        rxptr = rxbuf;
+        rxstart = rxbuf;
+        txptr = txbuf;
+        com_mode &= ~COM_MODE_RX;
+        if (header_hook && (header_len < count) && (rxbuf != 0))
+        {
+            com_mode |= COM_MODE_HEADER;
+        }
+        if (txcount)
+        {
+            if (spi_slave_prime(*txptr) == 0)
+            {
+                txptr++;
+            }
+            txcount--;
+        }
+        while ((UCzIFG & UCTXIFG) && txcount)
+        {
+            *(&(UCzTXBUF)) = *txptr++;  /* put in first character */
+            txcount--;
+        }
+        UCzIE |= UCRXIE;  /* need to receive data to transmit */
+    }
+    spi_slave_ready(1);  /* armed, TX data loaded */
+}
+
+/**
+    spi_slave_arm_rx() - arm a receive, the master is answered with 0xFF.
+*/
+static void spi_slave_arm_rx(uint8_t *buf, uint16_t count)
+{
+    spi_slave_half_stop();
+    com_mode &= ~(COM_MODE_ECHO | COM_MODE_HEADER | COM_MODE_STREAM);
+    spi_slave_ready(0);
+    rxcount = count;
+    txcount = count;
+    rxrecived = 0;
+    frame_begun = 0;
+    arm_rx = buf;
+    arm_count = count;
+#if SPI_SLAVE_DMA
+    if (com_mode & COM_MODE_DMA)
+    {
+        HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_CTL)) = 0;
+        HWREG16(SPI_DMA_TX(dma_idx, SPI_DMA_CTL)) = 0;
+        rxstart = buf;
+        if (count)  /* DMAxSZ = 0 would never complete */
+        {
+            /* Flush TX pipe and load the first byte */
+            spi_slave_prime(dummy);
+            // RXIFG
+            spi_slave_dma_rx(buf, count);
+
+            //TXIFG;
+            if (count > 1)
+            {
+                __data16_write_addr((unsigned short)SPI_DMA_TX(dma_idx, SPI_DMA_SA), (unsigned long)&dummy);
+                HWREG16(SPI_DMA_TX(dma_idx, SPI_DMA_SZ)) = count - 1;
+                HWREG16(SPI_DMA_TX(dma_idx, SPI_DMA_CTL)) = DMADT_0 + DMASBDB + DMALEVEL + DMAEN;
+            }
+        }
+    }
+    else
+#endif
+    {
+        rxptr = buf;
+        rxstart = buf;
+        txptr = (uint8_t *) &dummy;
+        com_mode |= COM_MODE_RX;
+        if (header_hook && (header_len < count))
+        {
+            com_mode |= COM_MODE_HEADER;
+        }
+        spi_slave_prime(dummy);
+        while ((UCzIFG & UCTXIFG))
+        {
+            *(&(UCzTXBUF)) = dummy;  /* put in first characters */
+        }
+        UCzIE |= UCRXIE;  /* need to receive data to transmit */
+    }
+}
+
+/**
+    spi_slave_receive() - send a bytes.
+*/
+void spi_slave_receive(uint8_t *buf, uint16_t count)
+{
+    quiet = 0;
+    arm_kind = ARM_RECEIVE;
+    SPI_TRACE_START(count, ((com_mode & COM_MODE_DMA) ? SPI_TRACE_DMA : 0) | ((header_hook && (header_len < count)) ? SPI_TRACE_HEADER : 0) | SPI_TRACE_RX_ONLY);
+    SPI_STATS_ARM();
+    spi_slave_arm_rx(buf, count);
+    spi_slave_ready(1);  /* armed, TX data loaded */
+}
+
+/**
+    spi_slave_probe() - receive count bytes outside of any frame.
+
+    As spi_slave_receive(), for a layer that hunts for a resync marker
+    after its framing was lost: the probe is not traced, not counted in
+    the statistics and leaves the ready pin idle. Its end goes to the
+    done hook as usual.
+*/
+void spi_slave_probe(uint8_t *buf, uint16_t count)
+{
+    quiet = 1;
+    arm_kind = ARM_PROBE;
+    spi_slave_arm_rx(buf, count);
+}
+
+/**
+    spi_slave_rearm() - arm the last transfer, receive or probe again on its buffers.
+
+    Returns 0 if there is nothing to re-arm: the slave was last put into
+    echo, stream or half-duplex mode, or was never armed.
+*/
+uint8_t spi_slave_rearm(void)
+{
+    switch (arm_kind)
+    {
+        case ARM_TRANSFER:
+            spi_slave_transfer(arm_rx, arm_tx, arm_count);
+            return (1);
+        case ARM_RECEIVE:
+            spi_slave_receive(arm_rx, arm_count);
+            return (1);
+        case ARM_PROBE:
+            spi_slave_probe(arm_rx, arm_count);
+            return (1);
+        default:
+            return (0);
+    }
+}
+
+/**
+    spi_slave_set_frame_timer() - time the start of every frame.
+
+    With on set the first byte of each transfer is stamped with millis()
+    for spi_slave_frame_started(): by the RX interrupt, in DMA mode by the
+    interrupt after the header. A DMA transfer without a header hook keeps
+    running without the CPU and is stamped by spi_slave_frame_started()
+    when it first sees bytes in, so the timer costs no SCK headroom.
+*/
+void spi_slave_set_frame_timer(uint8_t on)
+{
+    frame_timer = on;
+}
+
+/**
+    spi_slave_frame_started() - the armed transfer has begun, *ms is the millis() of its first byte.
+
+    Bytes that came in without a stamp (frame timer off, or a DMA phase
+    that has no interrupt) are stamped when first seen here.
+*/
+uint8_t spi_slave_frame_started(uint32_t *ms)
+{
+    uint8_t begun;
+    uint16_t sr;
+
+    sr = __get_SR_register();
+    __disable_interrupt();
+    if (!frame_begun && (spi_bytes_received() != 0) && !(com_mode & (COM_MODE_ECHO | COM_MODE_STREAM)))
+    {
+        frame_ms = millis();
+        frame_begun = 1;
+    }
+    begun = frame_begun;
+    *ms = frame_ms;
+    __bis_SR_register(sr & GIE);
+    return (begun);
+}
+
+/**
+    spi_slave_echo() - loop every received byte back to the master.
+
+    Each byte received is sent back in the following byte slot, so the
+    master sees its own data delayed by one byte. Without a transform the
+    RX DMA channel copies UCzRXBUF to UCzTXBUF on its own; with a transform
+    (or without DMA) the copy is done in spi_rx_isr(). Runs until the next
+    transfer, receive or disable call.
+*/
+void spi_slave_echo(uint8_t xor_mask, uint8_t increment)
+{
+#if SPI_SLAVE_ECHO
+    spi_slave_half_stop();
+    rxcount = 0;
+    txcount = 0;
+    rxrecived = 0;
+    quiet = 0;
+    arm_kind = ARM_NONE;
+    SPI_TRACE_START(0, SPI_TRACE_ECHO);
+    echo_xor = xor_mask;
+    echo_add = increment;
+#if SPI_SLAVE_DMA
+    if (com_mode & (COM_MODE_STREAM | COM_MODE_HALF | COM_MODE_TURN))
+    {
+        /* the interrupt path below leaves the channels alone */
+        HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_CTL)) = 0;
+        HWREG16(SPI_DMA_TX(dma_idx, SPI_DMA_CTL)) = 0;
+    }
+#endif
+    com_mode &= ~COM_MODE_STREAM;
+#if SPI_SLAVE_DMA
+    if ((com_mode & COM_MODE_DMA) && (xor_mask == 0) && (increment == 0))
+    {
+        HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_CTL)) = 0;
+        HWREG16(SPI_DMA_TX(dma_idx, SPI_DMA_CTL)) = 0;
+        /* Flush TX pipe, nothing to echo in the first slot */
+        spi_slave_prime(dummy);
+        com_mode |= COM_MODE_ECHO;
+        /* RXIFG: UCzRXBUF -> UCzTXBUF, repeated single transfer */
+        __data16_write_addr((unsigned short)SPI_DMA_RX(dma_idx, SPI_DMA_DA), (unsigned long)&UCzTXBUF);
+        HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_SZ)) = 1;
+        HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_CTL)) = DMADT_4 + DMASBDB + DMALEVEL + DMAEN;
+        spi_slave_ready(1);
+        return;
+    }
+#endif
+    rxptr = 0;
+    txptr = (uint8_t *) &dummy;
+    com_mode |= COM_MODE_ECHO;
+    spi_slave_prime(dummy);  /* nothing to echo in the first slot */
+    UCzIE |= UCRXIE;
+    spi_slave_ready(1);
+#else
+    (void)xor_mask;
+    (void)increment;
+#endif
+}
+
+#if SPI_SLAVE_STREAM
+/**
+    spi_slave_stream() - receive without end into the ring buf of size bytes.
+
+    There is no frame: the ring wraps at its end and the oldest data is
+    overwritten, the master is answered with 0xFF. With DMA the RX channel
+    runs as repeated block transfer over the ring and its interrupt only
+    counts the laps; without DMA spi_rx_isr() stores and wraps. Runs until
+    the next transfer, receive, echo, abort or disable call.
+*/
+void spi_slave_stream(uint8_t *buf, uint16_t size)
+{
+    spi_slave_half_stop();
+    com_mode &= ~(COM_MODE_ECHO | COM_MODE_HEADER);
+    spi_slave_ready(0);
+    if ((buf == 0) || (size == 0))
+    {
+        return;
+    }
+    rxcount = size;
+    txcount = 0;
+    rxrecived = 0;
+    rxptr = buf;
+    rxstart = buf;
+    txptr = (uint8_t *) &dummy;
+    stream_end = buf + size;
+    stream_size = size;
+    stream_laps = 0;
+    quiet = 0;
+    arm_kind = ARM_NONE;
+    SPI_TRACE_START(size, ((com_mode & COM_MODE_DMA) ? SPI_TRACE_DMA : 0) | SPI_TRACE_RX_ONLY | SPI_TRACE_STREAM);
+    com_mode |= COM_MODE_STREAM;
+#if SPI_SLAVE_DMA
+    if (com_mode & COM_MODE_DMA)
+    {
+        HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_CTL)) = 0;
+        HWREG16(SPI_DMA_TX(dma_idx, SPI_DMA_CTL)) = 0;
+        spi_slave_prime(dummy);
+        /* RXIFG: repeated block, DA and SZ reload at the end of the ring */
+        __data16_write_addr((unsigned short)SPI_DMA_RX(dma_idx, SPI_DMA_DA), (unsigned long)buf);
+        HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_SZ)) = size;
+        HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_CTL)) = DMADT_4 + DMADSTINCR + DMASBDB + DMALEVEL + DMAIE + DMAEN;
+        /* TXIFG: 0xFF for every byte */
+        __data16_write_addr((unsigned short)SPI_DMA_TX(dma_idx, SPI_DMA_SA), (unsigned long)&dummy);
+        HWREG16(SPI_DMA_TX(dma_idx, SPI_DMA_SZ)) = 1;
+        HWREG16(SPI_DMA_TX(dma_idx, SPI_DMA_CTL)) = DMADT_4 + DMASBDB + DMALEVEL + DMAEN;
+        spi_slave_ready(1);
+        return;
+    }
+#endif
+    spi_slave_prime(dummy);
+    UCzIE |= UCRXIE;
+    spi_slave_ready(1);
+}
+
+/**
+    spi_slave_stream_count() - bytes received since spi_slave_stream(), modulo 2^32.
+
+    Laps and ring position are read with interrupts off. In DMA mode a wrap
+    whose interrupt is still pending is counted here, DMAxSZ is then read
+    again since the first read may predate the reload.
+*/
+uint32_t spi_slave_stream_count(void)
+{
+    uint32_t laps;
+    uint16_t pos;
+    uint16_t sr;
+
+    sr = __get_SR_register();
+    __disable_interrupt();
+    laps = stream_laps;
+#if SPI_SLAVE_DMA
+    if (com_mode & COM_MODE_DMA)
+    {
+        pos = HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_SZ));
+        if (HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_CTL)) & DMAIFG)
+        {
+            pos = HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_SZ));
+            laps++;
+        }
+        pos = stream_size - pos;
+    }
+    else
+#endif
+    {
+        pos = rxptr - rxstart;
+    }
+    __bis_SR_register(sr & GIE);
+    return (laps * stream_size + pos);
+}
+#endif
+
+#if SPI_SLAVE_HALF_DUPLEX
+/**
+    spi_slave_half_duplex() - receive rx command bytes, then send tx response bytes on the same line.
+
+    One frame in two phases on a single data line (MODE_3WIRE_HALF, SIMO
+    and SOMI both wired to it). The data pin stays an input while the
+    command comes in; when rx bytes are in, spi_slave_turn() arms the
+    response and switches the pin to SOMI. With DMA each phase is one
+    block transfer and the DMA interrupt in between is the turnaround.
+    The master pauses SCK at the turnaround and releases the line before
+    it. The done hook is called with rx at the end of the response.
+*/
+void spi_slave_half_duplex(uint8_t *rxbuf, uint16_t rx, uint8_t *txbuf, uint16_t tx)
+{
+    spi_slave_half_stop();
+    com_mode &= ~(COM_MODE_ECHO | COM_MODE_HEADER | COM_MODE_STREAM | COM_MODE_RX);
+    spi_slave_ready(0);
+    if (rx == 0)
+    {
+        return;
+    }
+    rxcount = rx;
+    txcount = 0;
+    rxrecived = 0;
+    rxptr = rxbuf;
+    rxstart = rxbuf;
+    txptr = (uint8_t *) &dummy;
+    half_txbuf = txbuf;
+    half_tx = (txbuf != 0) ? tx : 0;
+    half_rx = rx;
+    quiet = 0;
+    frame_begun = 0;
+    arm_kind = ARM_NONE;
+    SPI_TRACE_START(rx + half_tx, ((com_mode & COM_MODE_DMA) ? SPI_TRACE_DMA : 0));
+    SPI_STATS_ARM();
+    com_mode |= COM_MODE_HALF;
+#if SPI_SLAVE_DMA
+    if (com_mode & COM_MODE_DMA)
+    {
+        HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_CTL)) = 0;
+        HWREG16(SPI_DMA_TX(dma_idx, SPI_DMA_CTL)) = 0;
+    }
+#endif
+    /* flush the TX pipe, nothing is sent before the turnaround */
+    UCzSWRST |= UCSWRST;
+    UCzSWRST &= ~UCSWRST;
+#if SPI_SLAVE_DMA
+    if (com_mode & COM_MODE_DMA)
+    {
+        /* RXIFG: the command, its DMA interrupt is the turnaround */
+        __data16_write_addr((unsigned short)SPI_DMA_RX(dma_idx, SPI_DMA_DA), (unsigned long)((rxbuf != 0) ? rxbuf : &rx_sink));
+        HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_SZ)) = rx;
+        HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_CTL)) = DMADT_0 + ((rxbuf != 0) ? DMADSTINCR : 0) + DMASBDB + DMALEVEL + DMAIE + DMAEN;
+    }
+    else
+#endif
+    {
+        UCzIE |= UCRXIE;  /* txcount is 0, the RX interrupt loads nothing */
+    }
+    spi_slave_ready(1);
+}
+
+/**
+    spi_slave_set_data_pin() - SOMI pin on the data line of spi_slave_half_duplex().
+
+    The pin is made an input now and gets pin_mode, its SOMI function,
+    only from the turnaround to the end of the response. Its direction and
+    select registers are resolved here, the interrupt handlers only set
+    and clear the bits. pin 0 stops the switching; the pin is left as it is.
+*/
+void spi_slave_set_data_pin(uint8_t pin, uint16_t pin_mode)
+{
+    uint8_t port;
+
+    data_dir = 0;
+    if (pin == 0)
+    {
+        return;
+    }
+    pinMode(pin, INPUT);
+    port = digitalPinToPort(pin);
+    data_mask = digitalPinToBitMask(pin);
+    data_sel0 = portSel0Register(port);
+    data_on0 = (pin_mode & PORT_SELECTION0) ? data_mask : 0;
+#if defined(portSel2Register)
+    data_sel1 = portSel2Register(port);
+    data_on1 = (pin_mode & PORT_SELECTION1) ? data_mask : 0;
+#elif defined(portSel1Register)
+    data_sel1 = portSel1Register(port);
+    data_on1 = (pin_mode & PORT_SELECTION1) ? data_mask : 0;
+#else
+    data_sel1 = data_sel0;
+    data_on1 = 0;
+#endif
+    data_out = (pin_mode & OUTPUT) ? data_mask : 0;
+    data_dir = portDirRegister(port);
+}
+
+/**
+    spi_slave_set_turn_hook() - callback at the turnaround of spi_slave_half_duplex().
+
+    Called in interrupt context with the command; it may fill the response
+    buffer and returns the number of response bytes to send, at most tx.
+    The master's pause at the turnaround has to cover the hook.
+*/
+void spi_slave_set_turn_hook(uint16_t (*hook)(uint8_t *command))
+{
+#if SPI_SLAVE_HOOKS
+    turn_hook = hook;
+#else
+    (void)hook;
+#endif
+}
+#endif
+
+/**
+    spi_slave_set_header_hook() - size each frame from its first bytes.
+
+    After header bytes of a transfer are received the hook is called (in
+    interrupt context) with a pointer to them and returns the number of
+    bytes still to receive; the transfer is cut down to that length. In
+    DMA mode the RX channel first receives only the header, the DMA
+    interrupt then re-arms it for the remainder within one byte time.
+*/
+void spi_slave_set_header_hook(uint16_t header, uint16_t (*hook)(uint8_t *header))
+{
+#if SPI_SLAVE_HOOKS
+    header_hook = 0;
+    header_len = header;
+    header_hook = hook;
+#else
+    (void)header;
+    (void)hook;
+#endif
+}
+
+/**
+    spi_slave_set_done_hook() - callback at the end of every transfer.
+
+    Called in interrupt context with the number of bytes received; the hook
+    may arm the next transfer right away.
+*/
+void spi_slave_set_done_hook(void (*hook)(uint16_t received))
+{
+#if SPI_SLAVE_HOOKS
+    done_hook = hook;
+#else
+    (void)hook;
+#endif
+}
+
+/**
+    spi_slave_set_status_hook() - supply the first response byte of every frame.
+
+    The hook is called when a transfer is armed, the last moment before CS
+    can be asserted, and its byte is clocked out first; the TX buffer
+    follows from the second byte on (count - 1 bytes of it are sent).
+*/
+void spi_slave_set_status_hook(uint8_t (*hook)(void))
+{
+#if SPI_SLAVE_HOOKS
+    status_hook = hook;
+#else
+    (void)hook;
+#endif
+}
+
+/**
+    spi_slave_set_ready_pin() - data-ready output for master flow control.
+
+    The pin is driven to active_level once a transfer is armed and its first
+    TX byte is loaded, and back when the transfer completes or the slave is
+    disabled. pin 0 turns the output off.
+*/
+void spi_slave_set_ready_pin(uint8_t pin, uint8_t active_level)
+{
+    ready_out = 0;
+    if (pin == 0)
+    {
+        return;
+    }
+    ready_mask = digitalPinToBitMask(pin);
+    ready_level = active_level;
+    pinMode(pin, OUTPUT);
+    digitalWrite(pin, (active_level == HIGH) ? LOW : HIGH);
+    ready_out = portOutputRegister(digitalPinToPort(pin));
+}
+
+int spi_bytes_to_transmit(void)
+{
+#if SPI_SLAVE_HALF_DUPLEX
+    if (com_mode & COM_MODE_HALF)
+    {
+        return (half_tx);  /* response not armed yet */
+    }
+#endif
+#if SPI_SLAVE_DMA
+    // when DMA enabled return DMAxSZ else done return 0
+    if (com_mode & COM_MODE_DMA)
+    {
+        return ((HWREG16(SPI_DMA_TX(dma_idx, SPI_DMA_CTL)) & DMAEN) ? HWREG16(SPI_DMA_TX(dma_idx, SPI_DMA_SZ)) : 0);
+    }
+#endif
+    return (txcount);
+}
+
+
+int spi_bytes_received(void)
+{
+#if SPI_SLAVE_HALF_DUPLEX
+    if (com_mode & COM_MODE_TURN)
+    {
+        return (half_rx);
+    }
+#endif
+#if SPI_SLAVE_DMA
+    // when DMA enabled return DMAxSZ else done return 0
+    if (com_mode & COM_MODE_DMA)
+    {
+        if (com_mode & COM_MODE_HEADER)
+        {
+            return ((HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_CTL)) & DMAEN) ? (header_len - HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_SZ))) : header_len);
+        }
+        return ((HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_CTL)) & DMAEN) ? (rxcount - HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_SZ))) : rxcount);
+    }
+    else
+    {
+        return (rxrecived);
+    }
+#else
+    return (rxrecived);
+#endif
+}
+
+
+#if SPI_SLAVE_ERRORS
+/**
+    spi_slave_errors() - receive overruns seen by the RX interrupt.
+
+    A byte was lost because the previous one was not read in time; on the
+    DMA path overruns are not visible.
+*/
+uint16_t spi_slave_errors(void)
+{
+    return (overruns);
+}
+#endif
+
+/**
+    spi_slave_uses_dma() - transfers of the slave module run on DMA.
+*/
+int spi_slave_uses_dma(void)
+{
+    return ((com_mode & COM_MODE_DMA) != 0);
+}
+
+int spi_data_done(void)
+{
+    if (com_mode & (COM_MODE_ECHO | COM_MODE_STREAM))
+    {
+        return (0);
+    }
+#if SPI_SLAVE_DMA
+    if (com_mode & COM_MODE_DMA)
+    {
+        /* between header and remainder the RX channel is briefly disabled */
+        return (!(HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_CTL)) & DMAEN) && !(com_mode & (COM_MODE_HEADER | COM_MODE_HALF | COM_MODE_TURN)));
+    }
+#endif
+    return (rxcount == 0);
+}
+
+
+void spi_rx_isr(uint8_t offset)
+{
+    uint8_t temp;
+    uint16_t rest;
+    uint8_t done = 0;
+#if SPI_SLAVE_ERRORS
+    if (UCzSTAT & UCOE)
+    {
+        overruns++;  /* cleared by the UCzRXBUF read below */
+    }
+#endif
+    if (com_mode & COM_MODE_ECHO)
+    {
+        *(&(UCzTXBUF)) = (*(&(UCzRXBUF)) ^ echo_xor) + echo_add;
+        rxrecived++;
+        return;
+    }
+    if (com_mode & COM_MODE_STREAM)
+    {
+        *rxptr++ = *(&(UCzRXBUF));
+        if (rxptr == stream_end)
+        {
+            rxptr = rxstart;
+            stream_laps++;
+        }
+        *(&(UCzTXBUF)) = dummy;
+        return;
+    }
+    temp = *txptr; // store in case tx and rx ptr are identical
+    if (rxcount)
+    {
+#if SPI_SLAVE_DIRECTION == SPI_SLAVE_TX_ONLY
+        (void)*(&(UCzRXBUF));  /* nothing stored, the read clears UCRXIFG */
+        rxcount--;
+        rxrecived++;
+        done = (rxcount == 0);
+#else
+        if (rxptr != 0)
+        {
+            *rxptr++ = *(&(UCzRXBUF));
+        }
+        else
+        {
+            (void)*(&(UCzRXBUF));  /* dropped, the read clears UCRXIFG */
+        }
+        rxcount--;
+        rxrecived++;
+        if ((com_mode & COM_MODE_HEADER) && (rxrecived == header_len))
+        {
+            com_mode &= ~COM_MODE_HEADER;
+            rest = header_hook(rxptr - header_len);
+            if (rest < rxcount)
+            {
+                txcount = (txcount > (rxcount - rest)) ? (txcount - (rxcount - rest)) : 0;
+                rxcount = rest;
+            }
+        }
+        done = (rxcount == 0);
+#endif
+        if (rxrecived == 1)
+        {
+            if (frame_timer)
+            {
+                frame_ms = millis();
+                frame_begun = 1;
+            }
+            SPI_STATS_FIRST();
+        }
+    }
+    else
+    {
+        UCzIE &= ~UCRXIE;  /* disable interrupt */
+    }
+    if (txcount)
+    {
+        if (txptr != 0)
+        {
+            *(&(UCzTXBUF)) = temp;
+            if (SPI_TX_STEP)
+            {
+                txptr++;
+            }
+            txcount--;
+        }
+    }
+    if (done)
+    {
+        UCzIE &= ~UCRXIE;  /* the done hook may re-arm */
+#if SPI_SLAVE_HALF_DUPLEX
+        if (com_mode & COM_MODE_HALF)
+        {
+            spi_slave_turn();
+            return;
+        }
+        if (com_mode & COM_MODE_TURN)
+        {
+            spi_slave_half_end();
+            return;
+        }
+#endif
+        spi_slave_complete(rxrecived);
+    }
+}
+
+#if SPI_SLAVE_DMA
+#if !defined(DMA_VECTOR) && defined(DACDMA_VECTOR)
+#define DMA_VECTOR DACDMA_VECTOR    /* F2xx: shared with the DAC12 */
+#endif
+
+/**
+    DMA interrupt - RX channel finished the header or the whole frame.
+
+    With SPI_SLAVE_DMA_VECTOR 0 this is spi_slave_dma_handler(), called
+    from the application's own DMA ISR; only the slave's RX channel flag
+    is looked at and cleared.
+*/
+#if SPI_SLAVE_DMA_VECTOR
+__attribute__((interrupt(DMA_VECTOR)))
+void spi_slave_dma_isr(void)
+#else
+void spi_slave_dma_handler(void)
+#endif
+{
+    uint16_t rest;
+    if (!(HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_CTL)) & DMAIFG))
+    {
+        return;
+    }
+    HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_CTL)) &= ~DMAIFG;
+    if (com_mode & COM_MODE_STREAM)
+    {
+        stream_laps++;  /* DMAxDA is back at the ring start */
+        return;
+    }
+#if SPI_SLAVE_HALF_DUPLEX
+    if (com_mode & COM_MODE_HALF)
+    {
+        spi_slave_turn();
+        return;
+    }
+#endif
+    if (com_mode & COM_MODE_HEADER)
+    {
+        com_mode &= ~COM_MODE_HEADER;
+        if (frame_timer)
+        {
+            frame_ms = millis();
+            frame_begun = 1;
+        }
+        rest = header_hook(rxstart);
+        if (rest > (rxcount - header_len))
+        {
+            rest = rxcount - header_len;
+        }
+        rxcount = header_len + rest;
+        if (rest)
+        {
+            /* UCzRXBUF holds the next byte until it is read, a full byte time to get here */
+            __data16_write_addr((unsigned short)SPI_DMA_RX(dma_idx, SPI_DMA_DA), (unsigned long)(rxstart + header_len));
+            HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_SZ)) = rest;
+            HWREG16(SPI_DMA_RX(dma_idx, SPI_DMA_CTL)) = DMADT_0 + DMADSTINCR + DMASBDB + DMALEVEL + DMAIE + DMAEN;
+            return;
+        }
+    }
+    /* frame may end before the armed TX block */
+    HWREG16(SPI_DMA_TX(dma_idx, SPI_DMA_CTL)) &= ~DMAEN;
+#if SPI_SLAVE_HALF_DUPLEX
+    if (com_mode & COM_MODE_TURN)
+    {
+        spi_slave_half_end();
+        return;
+    }
+#endif
+    spi_slave_complete(rxcount);
+}
+#elif !SPI_SLAVE_DMA_VECTOR
+void spi_slave_dma_handler(void)
+{
+}
+#endif
+
+
+/**
+    Block transfers for SPIMasterBlock on a module the SPI library runs as
+    master. Only the DMA channel pair of that module is set up here, it has
+    to differ from the pair the slave module uses.
+*/
+#if SPI_SLAVE_DMA
+static uint8_t master_idx = 0;      /* index to the master's DMA channel pair */
+static uint16_t master_rxbuf = 0;   /* address of the master's UCzRXBUF */
+static uint8_t master_sink;         /* RX DMA destination without rx buffer */
+
+/**
+    spi_master_block_begin() - route the DMA pair of module to its RXIFG/TXIFG.
+
+    Returns 1 if block transfers run on DMA, 0 if the caller has to fall
+    back to byte transfers: the module has no DMA trigger, is the slave's
+    own module, or its channel pair overlaps the one the slave runs on.
+*/
+uint8_t spi_master_block_begin(uint8_t module)
+{
+    const spi_slave_module_t *m = 0;
+    uint8_t slave_chan = dma_idx / SPI_DMA_STRIDE;
+    uint8_t i;
+
+    for (i = 0; i < spi_master_module_count; i++)
+    {
+        if (spi_master_modules[i].module == module)
+        {
+            m = &spi_master_modules[i];
+        }
+    }
+    if ((m == 0) || (m->dma_chan == SPI_DMA_NONE))
+    {
+        return (0);
+    }
+    if (slave_setup && (module == spiSlaveModule))
+    {
+        return (0);  /* the module is the slave */
+    }
+    if ((com_mode & COM_MODE_DMA) && (m->dma_chan + 1 >= slave_chan) && (m->dma_chan <= slave_chan + 1))
+    {
+        return (0);  /* a channel of the pair is taken by the slave */
+    }
+    master_idx = m->dma_chan * SPI_DMA_STRIDE;
+    master_rxbuf = m->rxbuf;
+    HWREG16(SPI_DMA_RX(master_idx, SPI_DMA_CTL)) = 0;
+    HWREG16(SPI_DMA_TX(master_idx, SPI_DMA_CTL)) = 0;
+    spi_slave_dma_trigger(m->dma_chan, m->rx_trigger);
+    __data16_write_addr((unsigned short)SPI_DMA_RX(master_idx, SPI_DMA_SA), (unsigned long)m->rxbuf);
+    spi_slave_dma_trigger(m->dma_chan + 1, m->tx_trigger);
+    __data16_write_addr((unsigned short)SPI_DMA_TX(master_idx, SPI_DMA_DA), (unsigned long)m->txbuf);
+    return (1);
+}
+
+/**
+    spi_master_block_start() - clock count bytes out of txbuf into rxbuf.
+
+    Either buffer may be 0: 0xFF is sent, received bytes are dropped. RX
+    sits on the lower channel, so it wins over TX and cannot overrun. The
+    TX channel starts at once since UCTXIFG is set on an idle master.
+*/
+void spi_master_block_start(uint8_t *rxbuf, const uint8_t *txbuf, uint16_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    (void)HWREG8(master_rxbuf);  /* drop a stale UCRXIFG */
+    __data16_write_addr((unsigned short)SPI_DMA_RX(master_idx, SPI_DMA_DA), (unsigned long)(rxbuf ? rxbuf : &master_sink));
+    HWREG16(SPI_DMA_RX(master_idx, SPI_DMA_SZ)) = count;
+    HWREG16(SPI_DMA_RX(master_idx, SPI_DMA_CTL)) = DMADT_0 + (rxbuf ? DMADSTINCR : 0) + DMASBDB + DMALEVEL + DMAEN;
+    __data16_write_addr((unsigned short)SPI_DMA_TX(master_idx, SPI_DMA_SA), (unsigned long)(txbuf ? txbuf : &dummy));
+    HWREG16(SPI_DMA_TX(master_idx, SPI_DMA_SZ)) = count;
+    HWREG16(SPI_DMA_TX(master_idx, SPI_DMA_CTL)) = DMADT_0 + (txbuf ? DMASRCINCR : 0) + DMASBDB + DMALEVEL + DMAEN;
+}
+
+/**
+    spi_master_block_busy() - the block is still being clocked.
+*/
+int spi_master_block_busy(void)
+{
+    return ((HWREG16(SPI_DMA_RX(master_idx, SPI_DMA_CTL)) & DMAEN) != 0);
+}
+#else
+uint8_t spi_master_block_begin(uint8_t module)
+{
+    (void)module;
+    return (0);
+}
+
+void spi_master_block_start(uint8_t *rxbuf, const uint8_t *txbuf, uint16_t count)
+{
+    (void)rxbuf;
+    (void)txbuf;
+    (void)count;
+}
+
+int spi_master_block_busy(void)
+{
+    return (0);
+}
+#endif
+
+
+#endif // #if SPI_SLAVE_UCX
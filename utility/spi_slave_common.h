@@ -0,0 +1,157 @@
+/*
+    spi_slave_common.h - shared part of the USCI and eUSCI SPI Slave implementations
+
+    spi slave implementation by StefanSch
+    based on:
+    Copyright (c) 2012 by Rick Kimball <rick@kimballsoftware.com>
+    spi slave abstraction api for msp430
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+    usci_spi_slave.cpp and eusci_spi_slave.cpp only hold what differs
+    between the two module families: register access (usci_spi_slave.h,
+    eusci_spi_slave.h), the DMA trigger table and the mode setup. The
+    transfer logic, hooks, DMA arm and drain and the interrupt handlers
+    are in spi_slave_common.cpp, built against the family of the device.
+    extras/spi_host_test runs them on the host against a register model.
+
+*/
+
+#ifndef _SPI_SLAVE_COMMON_H_
+#define _SPI_SLAVE_COMMON_H_
+
+#include <msp430.h>
+#include <stdint.h>
+#include "spi_slave_430.h"
+
+#ifndef __data16_write_addr
+#define __data16_write_addr(x,y) *(unsigned long int*)(x) = y
+#endif
+#ifndef HWREG8
+#define HWREG8(x)                                                              \
+    (*((volatile uint8_t*)((uint16_t)(x))))
+#endif
+#ifndef HWREG16
+#define HWREG16(x)                                                             \
+    (*((volatile uint16_t*)((uint16_t)(x))))
+#endif
+
+#if defined(__MSP430_HAS_EUSCI_B0__) || defined(__MSP430_HAS_EUSCI_A0__)
+#include "eusci_spi_slave.h"
+#define SPI_SLAVE_UCX 1
+#elif defined(__MSP430_HAS_USCI_B0__) || defined(__MSP430_HAS_USCI_B1__) || defined(__MSP430_HAS_USCI__)
+#include "usci_spi_slave.h"
+#define SPI_SLAVE_UCX 1
+#else
+#define SPI_SLAVE_UCX 0     /* USI, see usi_spi_slave.cpp */
+#endif
+
+#if SPI_SLAVE_UCX
+
+/*
+    DMA controller, one feature test for both module families:
+    1 - F5xx/F6xx/FRxx DMAX, channel registers at DMA_BASE + OFS_DMAxCTL,
+        a 5 bit trigger field per byte of DMACTL0..DMACTL2
+    2 - F2xx DMA, channel registers at DMA0CTL_, the 4 bit trigger fields
+        of all channels packed into DMACTL0
+    extras/spi_host_test checks both layouts on the host.
+*/
+#if defined(DMA_BASE) && defined(OFS_DMA0CTL)
+#define SPI_SLAVE_HAS_DMA 1
+#elif defined(__MSP430_HAS_DMA_3__) || defined(__MSP430_HAS_DMA_1__)
+#define SPI_SLAVE_HAS_DMA 2
+#else
+#define SPI_SLAVE_HAS_DMA 0
+#endif
+
+#if SPI_SLAVE_HAS_DMA && SPI_SLAVE_USE_DMA
+#define SPI_SLAVE_DMA 1
+#else
+#define SPI_SLAVE_DMA 0
+#endif
+
+#if SPI_SLAVE_HAS_DMA == 1
+#define SPI_DMA_CH0              (DMA_BASE + OFS_DMA0CTL)
+#define SPI_DMA_STRIDE           (OFS_DMA1CTL - OFS_DMA0CTL)
+#define SPI_DMA_TSEL_REG(chan)   (DMA_BASE + OFS_DMACTL0 + (((chan) >> 1) << 1))
+#define SPI_DMA_TSEL_SHIFT(chan) (((chan) & 1) << 3)
+#define SPI_DMA_TSEL_MASK        0x1F
+#elif SPI_SLAVE_HAS_DMA == 2
+#define SPI_DMA_CH0              DMA0CTL_
+#define SPI_DMA_STRIDE           (DMA1CTL_ - DMA0CTL_)
+#define SPI_DMA_TSEL_REG(chan)   DMACTL0_
+#define SPI_DMA_TSEL_SHIFT(chan) ((chan) << 2)
+#define SPI_DMA_TSEL_MASK        0x0F
+#ifndef DMASRCINCR
+#define DMASRCINCR DMASRCINCR_3
+#endif
+#ifndef DMADSTINCR
+#define DMADSTINCR DMADSTINCR_3
+#endif
+#ifndef DMASBDB
+#define DMASBDB (DMASRCBYTE + DMADSTBYTE)
+#endif
+#endif
+
+/* register offsets within one channel, same on both controllers */
+#define SPI_DMA_CTL 0x00
+#define SPI_DMA_SA  0x02
+#define SPI_DMA_DA  0x06
+#define SPI_DMA_SZ  0x0A
+
+/* registers of the RX channel of the pair at index idx, TX is the next channel */
+#define SPI_DMA_RX(idx, reg)     (SPI_DMA_CH0 + (idx) + (reg))
+#define SPI_DMA_TX(idx, reg)     (SPI_DMA_CH0 + SPI_DMA_STRIDE + (idx) + (reg))
+
+/**
+    Module map - one entry per module that can act as SPI slave.
+
+    Holds the module base address, the addresses of its RX/TX buffers and the
+    DMA channel pair (RX on dma_chan, TX on dma_chan + 1) with the trigger
+    numbers of the module's RX/TX flags. The triggers are taken from the
+    device header for exactly that channel, so a module without a DMA trigger
+    on this device is flagged SPI_DMA_NONE and runs in interrupt mode.
+*/
+
+#define SPI_DMA_NONE 0xFF
+/* DMAxTSEL__ values are pre-shifted for odd channels, keep the raw trigger number */
+#define SPI_DMA_TRIG(t) ((uint8_t)(((t) | ((t) >> 8)) & 0x1F))
+
+typedef struct
+{
+    uint16_t base;        /* module base address */
+    uint16_t rxbuf;       /* address of UCzRXBUF (DMA source) */
+    uint16_t txbuf;       /* address of UCzTXBUF (DMA destination) */
+    uint8_t  module;      /* module number as used by setModule() */
+    uint8_t  dma_chan;    /* RX channel, TX uses dma_chan + 1 */
+    uint8_t  rx_trigger;  /* DMA trigger number of UCRXIFG */
+    uint8_t  tx_trigger;  /* DMA trigger number of UCTXIFG */
+} spi_slave_module_t;
+
+#define SPI_SLAVE_MODULE_(num, base, chan, rx, tx) \
+    { (base), (base) + OFS_UCzRXBUF, (base) + OFS_UCzTXBUF, num, chan, SPI_DMA_TRIG(rx), SPI_DMA_TRIG(tx) }
+/* extra level so that the UCzN_DMA triple is expanded into three arguments */
+#define SPI_SLAVE_MODULE(num, base, dma) SPI_SLAVE_MODULE_(num, base, dma)
+
+/* provided by the backend of the module family */
+extern const spi_slave_module_t spi_slave_modules[];
+extern const uint8_t spi_slave_module_count;
+#if SPI_SLAVE_DMA
+extern const spi_slave_module_t spi_master_modules[];
+extern const uint8_t spi_master_module_count;
+#endif
+
+/* provided by spi_slave_common.cpp */
+extern uint8_t half_wire;
+const spi_slave_module_t *spi_slave_find_module(uint16_t base);
+void spi_slave_setup(const uint8_t mode);
+#if SPI_SLAVE_DMA
+void spi_slave_dma_trigger(uint8_t chan, uint8_t trigger);
+#endif
+
+#endif /* SPI_SLAVE_UCX */
+
+#endif /*_SPI_SLAVE_COMMON_H_*/
@@ -0,0 +1,98 @@
+/*
+    spi_slave_config.h - compile time configuration of the SPI Slave implementations
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+    Each setting can be changed here or defined before this header is
+    included. The defaults build everything, as before; turning features
+    off removes their branches from the interrupt handlers and their code
+    from flash.
+
+*/
+
+#ifndef _SPI_SLAVE_CONFIG_H_
+#define _SPI_SLAVE_CONFIG_H_
+
+/* Use DMA where the part has it; 0 always runs on the RX interrupt. */
+#ifndef SPI_SLAVE_USE_DMA
+#define SPI_SLAVE_USE_DMA 1
+#endif
+
+/*
+    With DMA the slave owns the DMA interrupt vector (DMA_VECTOR) of the
+    whole application: a second DMA_VECTOR handler, in the sketch or in
+    another library, does not link. Set 0 to keep the vector for the
+    application; its DMA ISR then has to call spi_slave_dma_handler() on
+    every DMA interrupt, before it reads DMAIV, which would clear the flag
+    of the slave's RX channel.
+*/
+#ifndef SPI_SLAVE_DMA_VECTOR
+#define SPI_SLAVE_DMA_VECTOR 1
+#endif
+
+/*
+    Build support for one module only, numbered as for setModule()
+    (0..3 = UCBx, 10..13 = UCAx). 0xFF keeps all modules of the part.
+*/
+#ifndef SPI_SLAVE_ONLY_MODULE
+#define SPI_SLAVE_ONLY_MODULE 0xFF
+#endif
+#define SPI_SLAVE_MODULE_USED(n) ((SPI_SLAVE_ONLY_MODULE == 0xFF) || (SPI_SLAVE_ONLY_MODULE == (n)))
+
+/* Data direction: TX_ONLY never stores received bytes, RX_ONLY always sends dummy bytes. */
+#define SPI_SLAVE_DUPLEX  0
+#define SPI_SLAVE_RX_ONLY 1
+#define SPI_SLAVE_TX_ONLY 2
+#ifndef SPI_SLAVE_DIRECTION
+#define SPI_SLAVE_DIRECTION SPI_SLAVE_DUPLEX
+#endif
+
+/* echo() support */
+#ifndef SPI_SLAVE_ECHO
+#define SPI_SLAVE_ECHO 1
+#endif
+
+/* stream() support: endless receive into a ring, drained with readBlock() */
+#ifndef SPI_SLAVE_STREAM
+#define SPI_SLAVE_STREAM 1
+#endif
+
+/*
+    halfDuplex(): command and response share one data line, the data pin
+    only drives it after the turnaround. Needs SPI_SLAVE_DUPLEX.
+*/
+#ifndef SPI_SLAVE_HALF_DUPLEX
+#define SPI_SLAVE_HALF_DUPLEX 1
+#endif
+#if SPI_SLAVE_DIRECTION != SPI_SLAVE_DUPLEX
+#undef SPI_SLAVE_HALF_DUPLEX
+#define SPI_SLAVE_HALF_DUPLEX 0
+#endif
+
+/*
+    Header, done and status hooks. With 0 the setters are kept but have
+    no effect; SPISlavePacket needs the hooks.
+*/
+#ifndef SPI_SLAVE_HOOKS
+#define SPI_SLAVE_HOOKS 1
+#endif
+
+/* Count receive overruns (UCOE) in the RX interrupt, read with spi_slave_errors(). */
+#ifndef SPI_SLAVE_ERRORS
+#define SPI_SLAVE_ERRORS 0
+#endif
+
+/* Transaction trace ring, see spi_slave_trace.h */
+#ifndef SPI_SLAVE_TRACE
+#define SPI_SLAVE_TRACE 0
+#endif
+
+/* Rolling link statistics, see spi_slave_stats.h */
+#ifndef SPI_SLAVE_STATS
+#define SPI_SLAVE_STATS 0
+#endif
+
+#endif /*_SPI_SLAVE_CONFIG_H_*/
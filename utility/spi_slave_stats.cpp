@@ -0,0 +1,276 @@
+/*
+    spi_slave_stats.cpp - rolling link statistics of the SPI Slave implementations
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <Energia.h>
+#include "spi_slave_stats.h"
+
+#if SPI_SLAVE_STATS
+
+#define STATS_AVG_SHIFT 4           /* moving averages over 2^4 frames */
+#define STATS_WINDOW_US 1000000UL
+
+static spi_slave_stats_t stats;
+static uint16_t histogram[SPI_SLAVE_STATS_BUCKETS];
+static uint32_t interval_avg = 0;   /* mean << STATS_AVG_SHIFT */
+static uint32_t latency_avg = 0;
+static uint32_t arm_us = 0;
+static uint32_t end_us = 0;
+static uint32_t window_us = 0;
+static uint16_t window_frames = 0;
+static uint32_t window_bytes = 0;
+static uint16_t rate_frames = 0;    /* counts of the last full window */
+static uint32_t rate_bytes = 0;
+static uint32_t rate_us = 0;        /* its length, 0 before the first one */
+static uint8_t latency_seeded = 0;  /* latency_avg holds a sample */
+static uint8_t armed = 0;           /* waiting for the first byte */
+static uint8_t open = 0;            /* armed, not yet ended or aborted */
+static uint8_t ended = 0;           /* end_us is valid */
+
+static uint16_t spi_slave_stats_clip(uint32_t us)
+{
+    return ((us > 0xFFFF) ? 0xFFFF : us);
+}
+
+/* avg holds the mean << STATS_AVG_SHIFT, the first sample seeds it */
+static void spi_slave_stats_average(uint32_t *avg, uint16_t sample, uint8_t first)
+{
+    if (first)
+    {
+        *avg = (uint32_t)sample << STATS_AVG_SHIFT;
+    }
+    else
+    {
+        *avg = *avg - (*avg >> STATS_AVG_SHIFT) + sample;
+    }
+}
+
+/* histogram bucket n holds samples below 2^n us */
+static void spi_slave_stats_bucket(uint16_t us)
+{
+    uint8_t n = 0;
+    uint8_t i;
+
+    while (us && (n < (SPI_SLAVE_STATS_BUCKETS - 1)))
+    {
+        us >>= 1;
+        n++;
+    }
+    if (histogram[n] == 0xFFFF)
+    {
+        /* age the histogram instead of losing the count */
+        for (i = 0; i < SPI_SLAVE_STATS_BUCKETS; i++)
+        {
+            histogram[i] >>= 1;
+        }
+    }
+    histogram[n]++;
+}
+
+/**
+    spi_slave_stats_arm() - a transfer is armed.
+
+    Only an arm between frames starts the latency clock: one while the
+    armed frame has already seen its first byte re-arms in the middle of
+    the master's frame, its next byte is no response to the arm.
+*/
+void spi_slave_stats_arm(void)
+{
+    if (open && !armed)
+    {
+        return;
+    }
+    arm_us = micros();
+    armed = 1;
+    open = 1;
+}
+
+/**
+    spi_slave_stats_first() - first byte of the armed transfer, interrupt mode.
+*/
+void spi_slave_stats_first(void)
+{
+    uint16_t latency;
+
+    if (!armed)
+    {
+        return;
+    }
+    armed = 0;
+    latency = spi_slave_stats_clip(micros() - arm_us);
+    spi_slave_stats_average(&latency_avg, latency, !latency_seeded);
+    latency_seeded = 1;
+    if (latency > stats.latency_max)
+    {
+        stats.latency_max = latency;
+    }
+}
+
+/**
+    spi_slave_stats_end() - the armed transfer completed, interrupt context.
+*/
+void spi_slave_stats_end(uint16_t received)
+{
+    uint32_t now = micros();
+    uint32_t elapsed;
+    uint16_t interval;
+    uint8_t i;
+
+    armed = 0;
+    open = 0;
+    stats.frames++;
+    stats.bytes += received;
+    if (ended)
+    {
+        interval = spi_slave_stats_clip(now - end_us);
+        spi_slave_stats_average(&interval_avg, interval, stats.frames == 2);
+        spi_slave_stats_bucket(interval);
+    }
+    else
+    {
+        window_us = now;
+    }
+    ended = 1;
+    end_us = now;
+
+    window_frames++;
+    window_bytes += received;
+    elapsed = now - window_us;
+    if (elapsed >= STATS_WINDOW_US)
+    {
+        /* the reader divides, each window halves the histogram */
+        rate_frames = window_frames;
+        rate_bytes = window_bytes;
+        rate_us = elapsed;
+        window_frames = 0;
+        window_bytes = 0;
+        window_us = now;
+        for (i = 0; i < SPI_SLAVE_STATS_BUCKETS; i++)
+        {
+            histogram[i] >>= 1;
+        }
+    }
+}
+
+/**
+    spi_slave_stats_abort() - the armed transfer was dropped.
+
+    An abort after the transfer already ended drops nothing and is not counted.
+*/
+void spi_slave_stats_abort(void)
+{
+    if (open)
+    {
+        stats.aborts++;
+    }
+    armed = 0;
+    open = 0;
+}
+
+/**
+    spi_slave_stats_close() - the frame of the armed transfer ended on CS.
+
+    Counted as a completed frame, unless its end was already counted.
+*/
+void spi_slave_stats_close(uint16_t received)
+{
+    if (open)
+    {
+        spi_slave_stats_end(received);
+    }
+}
+
+/**
+    spi_slave_stats_queue() - report the depth of a queue after a frame was added.
+*/
+void spi_slave_stats_queue(uint8_t depth)
+{
+    if (depth > stats.queue_high)
+    {
+        stats.queue_high = depth;
+    }
+}
+
+/**
+    spi_slave_stats_read() - snapshot of the figures.
+
+    Rates fall to 0 when no frame ended for two windows. The p99 is taken
+    over the decaying histogram: the current window counts in full, each
+    older one half as much as the one after it.
+*/
+void spi_slave_stats_read(spi_slave_stats_t *out)
+{
+    uint32_t total = 0;
+    uint32_t sum = 0;
+    uint16_t frames;
+    uint32_t bytes;
+    uint32_t ms;
+    uint16_t sr;
+    uint8_t i;
+
+    sr = __get_SR_register();
+    __disable_interrupt();
+    *out = stats;
+    out->interval_mean = interval_avg >> STATS_AVG_SHIFT;
+    out->latency_mean = latency_avg >> STATS_AVG_SHIFT;
+    frames = rate_frames;
+    bytes = rate_bytes;
+    ms = rate_us / 1000;
+    if (!ended || ((uint32_t)(micros() - end_us) >= 2 * STATS_WINDOW_US))
+    {
+        ms = 0;
+    }
+    for (i = 0; i < SPI_SLAVE_STATS_BUCKETS; i++)
+    {
+        total += histogram[i];
+    }
+    out->interval_p99 = 0;
+    for (i = 0; (i < SPI_SLAVE_STATS_BUCKETS) && total; i++)
+    {
+        sum += histogram[i];
+        if ((sum * 100) >= (total * 99))
+        {
+            out->interval_p99 = (i < (SPI_SLAVE_STATS_BUCKETS - 1)) ? spi_slave_stats_clip((1UL << i) - 1) : 0xFFFF;
+            break;
+        }
+    }
+    __bis_SR_register(sr & GIE);
+    out->frames_per_s = ms ? (((uint32_t)frames * 1000) / ms) : 0;
+    out->bytes_per_s = ms ? ((bytes * 1000) / ms) : 0;
+}
+
+void spi_slave_stats_clear(void)
+{
+    uint16_t sr;
+    uint8_t i;
+
+    sr = __get_SR_register();
+    __disable_interrupt();
+    memset(&stats, 0, sizeof(stats));
+    for (i = 0; i < SPI_SLAVE_STATS_BUCKETS; i++)
+    {
+        histogram[i] = 0;
+    }
+    interval_avg = 0;
+    latency_avg = 0;
+    latency_seeded = 0;
+    window_frames = 0;
+    window_bytes = 0;
+    rate_frames = 0;
+    rate_bytes = 0;
+    rate_us = 0;
+    armed = 0;
+    open = 0;
+    ended = 0;
+    __bis_SR_register(sr & GIE);
+}
+
+#endif
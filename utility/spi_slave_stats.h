@@ -0,0 +1,81 @@
+/*
+    spi_slave_stats.h - rolling link statistics of the SPI Slave implementations
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+    The backends update the figures when a transfer is armed, on its
+    first byte and when it completes; only integer adds and shifts run in
+    interrupt context, spi_slave_stats_read() does the divisions. Rates
+    cover the last full second, means are moving averages over about 16
+    frames, the interval p99 comes from a log2 histogram that is halved
+    every second, so it follows the last few seconds.
+
+    Frame starts are not seen on DMA, so the interval is measured between
+    the ends of two frames and the latency (armed to first byte) is only
+    measured in interrupt mode, from arms between frames. With a ready pin
+    the slave is armed when it signals ready, so the latency is what the
+    master adds between ready and its first clock. A frame ended by CS
+    (spi_slave_close()) counts as completed, only spi_slave_abort() counts
+    as an abort; resync probes (spi_slave_probe()) are not counted.
+
+    Set SPI_SLAVE_STATS to 1 in spi_slave_config.h to compile them in.
+
+*/
+
+#ifndef _SPI_SLAVE_STATS_H_
+#define _SPI_SLAVE_STATS_H_
+
+#include <stdint.h>
+#include "spi_slave_config.h"
+
+#ifndef SPI_SLAVE_STATS_BUCKETS
+#define SPI_SLAVE_STATS_BUCKETS 16  /* interval histogram, bucket n < 2^n us */
+#endif
+
+typedef struct
+{
+    uint32_t frames;          /* completed frames since clear */
+    uint32_t bytes;           /* bytes received in them */
+    uint16_t aborts;          /* armed transfers dropped by spi_slave_abort() */
+    uint16_t frames_per_s;    /* last full second */
+    uint32_t bytes_per_s;
+    uint16_t interval_mean;   /* us between frame ends */
+    uint16_t interval_p99;    /* us, upper bound of the 99th percentile bucket, recent seconds weighted */
+    uint16_t latency_mean;    /* us from armed to first byte, interrupt mode */
+    uint16_t latency_max;
+    uint8_t  queue_high;      /* high-water mark of the packet or frame queue */
+} spi_slave_stats_t;
+
+#if SPI_SLAVE_STATS
+
+void spi_slave_stats_arm(void);
+void spi_slave_stats_first(void);
+void spi_slave_stats_end(uint16_t received);
+void spi_slave_stats_abort(void);
+void spi_slave_stats_close(uint16_t received);
+void spi_slave_stats_queue(uint8_t depth);
+void spi_slave_stats_read(spi_slave_stats_t *stats);
+void spi_slave_stats_clear(void);
+
+#define SPI_STATS_ARM()          spi_slave_stats_arm()
+#define SPI_STATS_FIRST()        spi_slave_stats_first()
+#define SPI_STATS_END(received)  spi_slave_stats_end(received)
+#define SPI_STATS_ABORT()        spi_slave_stats_abort()
+#define SPI_STATS_CLOSE(received) spi_slave_stats_close(received)
+#define SPI_STATS_QUEUE(depth)   spi_slave_stats_queue(depth)
+
+#else
+
+#define SPI_STATS_ARM()
+#define SPI_STATS_FIRST()
+#define SPI_STATS_END(received)
+#define SPI_STATS_ABORT()
+#define SPI_STATS_CLOSE(received)
+#define SPI_STATS_QUEUE(depth)
+
+#endif
+
+#endif /*_SPI_SLAVE_STATS_H_*/
@@ -0,0 +1,264 @@
+/*
+    spi_slave_timing.h - timing model of the SPI Slave implementations
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+    Predicts from MCLK, module family, transfer mode and frame profile
+    how fast a master may clock the slave: the highest safe SCK, the
+    shortest CS high time between frames and, for the USI, the pause
+    needed between 16 bit words. For halfDuplex() frames also the pause
+    the master leaves at the turnaround. The header has no hardware dependency,
+    it is shared by the target (spi_slave_clock.h, examples) and by the
+    host tool in extras/spi_timing.
+
+    The SPI_TIMING_xxx figures are MCLK cycles of the code paths in the
+    backends as built by msp430-gcc with -Os, counted from the
+    instruction sequences with interrupt entry and exit. They are meant
+    to be checked on the board, e.g. with SPI_Stress_Master or
+    SPI_Energy_Benchmark, and can be overridden before this header is
+    included.
+
+*/
+
+#ifndef _SPI_SLAVE_TIMING_H_
+#define _SPI_SLAVE_TIMING_H_
+
+#include <stdint.h>
+
+/* interrupt accept plus RETI */
+#ifndef SPI_TIMING_IRQ
+#define SPI_TIMING_IRQ          11
+#endif
+/* USCI/eUSCI vector: register save, UCzIV read, call of spi_rx_isr() */
+#ifndef SPI_TIMING_DISPATCH
+#define SPI_TIMING_DISPATCH     28
+#endif
+/* spi_rx_isr() per byte: store one, load one */
+#ifndef SPI_TIMING_RX_BYTE
+#define SPI_TIMING_RX_BYTE      42
+#endif
+/* spi_rx_isr() per byte after receive(), TX stays on the dummy byte */
+#ifndef SPI_TIMING_RX_ONLY_BYTE
+#define SPI_TIMING_RX_ONLY_BYTE 34
+#endif
+/* USI counter interrupt per 16 bit word, register save included */
+#ifndef SPI_TIMING_USI_WORD
+#define SPI_TIMING_USI_WORD     64
+#endif
+/* DMA per byte: one RX and one TX transfer of 2 cycles each */
+#ifndef SPI_TIMING_DMA_BYTE
+#define SPI_TIMING_DMA_BYTE     4
+#endif
+/* a DMA request waits for the CPU instruction in progress */
+#ifndef SPI_TIMING_DMA_WAIT
+#define SPI_TIMING_DMA_WAIT     6
+#endif
+/* spi_slave_dma_isr() up to the completion */
+#ifndef SPI_TIMING_DMA_ISR
+#define SPI_TIMING_DMA_ISR      40
+#endif
+/* header hook path of spi_slave_dma_isr(): re-arm of the RX channel */
+#ifndef SPI_TIMING_DMA_HEADER
+#define SPI_TIMING_DMA_HEADER   60
+#endif
+/* spi_slave_complete() without hooks, ready pin included */
+#ifndef SPI_TIMING_COMPLETE
+#define SPI_TIMING_COMPLETE     30
+#endif
+/* spi_slave_transfer() on the DMA path, prime included */
+#ifndef SPI_TIMING_ARM_DMA
+#define SPI_TIMING_ARM_DMA      150
+#endif
+/* spi_slave_transfer() on the interrupt path, prime included */
+#ifndef SPI_TIMING_ARM_ISR
+#define SPI_TIMING_ARM_ISR      110
+#endif
+/* CS port interrupt with spi_slave_abort() */
+#ifndef SPI_TIMING_ABORT
+#define SPI_TIMING_ABORT        120
+#endif
+/* data pin switch at a half-duplex turnaround: PxSEL0, PxSEL1 and PxDIR
+   set through pointers, cleared the same way when the frame ends */
+#ifndef SPI_TIMING_PIN
+#define SPI_TIMING_PIN          36
+#endif
+/* other interrupts that may delay the slave, e.g. the system tick */
+#ifndef SPI_TIMING_JITTER
+#define SPI_TIMING_JITTER       60
+#endif
+
+/* slave mode SCK limit of the module, see the data sheet of the part */
+#ifndef SPI_TIMING_SCK_LIMIT_EUSCI
+#define SPI_TIMING_SCK_LIMIT_EUSCI 10000000UL
+#endif
+#ifndef SPI_TIMING_SCK_LIMIT_USCI
+#define SPI_TIMING_SCK_LIMIT_USCI  8000000UL
+#endif
+#ifndef SPI_TIMING_SCK_LIMIT_USI
+#define SPI_TIMING_SCK_LIMIT_USI   8000000UL
+#endif
+
+/* module families */
+#define SPI_TIMING_EUSCI    0
+#define SPI_TIMING_USCI     1
+#define SPI_TIMING_USI      2
+
+/* profile mode bits */
+#define SPI_TIMING_DMA      0x01    /* transfers on DMA, else on the RX interrupt */
+#define SPI_TIMING_RX_ONLY  0x02    /* receive(), dummy bytes sent */
+#define SPI_TIMING_HEADER   0x08    /* header hook sizes each frame */
+#define SPI_TIMING_CS_END   0x10    /* frames end on the CS release handler (abort and re-arm) */
+#define SPI_TIMING_HALF     0x20    /* halfDuplex(), the frame is command and response */
+
+typedef struct
+{
+    uint32_t mclk_hz;
+    uint8_t  module;        /* SPI_TIMING_EUSCI / USCI / USI */
+    uint8_t  mode;          /* SPI_TIMING_xxx bits */
+    uint16_t frame;         /* bytes per frame */
+    uint16_t hook_cycles;   /* cycles spent in the application's header, turn and done hooks */
+} spi_timing_profile_t;
+
+typedef struct
+{
+    uint16_t byte_cycles;   /* cycles that have to fit into one byte time */
+    uint16_t header_cycles; /* cycles that have to fit into the byte after the header */
+    uint16_t word_cycles;   /* USI: cycles of the pause between 16 bit words */
+    uint16_t gap_cycles;    /* cycles from the end of a frame until the next one is armed */
+    uint16_t turn_cycles;   /* halfDuplex(): cycles from the last command byte until the data pin drives */
+    uint32_t sck_max_hz;    /* highest safe SCK */
+    uint32_t word_gap_ns;   /* USI: pause the master leaves between 16 bit words */
+    uint32_t cs_gap_ns;     /* shortest CS high time between frames */
+    uint32_t turn_ns;       /* halfDuplex(): SCK pause at the turnaround */
+    uint32_t frames_per_s;  /* frame rate at sck_max_hz and cs_gap_ns */
+} spi_timing_t;
+
+/* MCLK cycles to ns, rounded up */
+static inline uint32_t spi_timing_ns(uint32_t cycles, uint32_t mclk_hz)
+{
+    uint32_t per_10us = mclk_hz / 100000UL;  /* cycles per 10 us */
+
+    if (per_10us == 0)
+    {
+        return (0xFFFFFFFFUL);
+    }
+    return ((cycles * 10000UL + per_10us - 1) / per_10us);
+}
+
+/* highest SCK at which cycles fit into one byte time */
+static inline uint32_t spi_timing_sck(uint32_t cycles, uint32_t mclk_hz)
+{
+    return ((cycles == 0) ? 0xFFFFFFFFUL : ((mclk_hz / cycles) * 8));
+}
+
+/*
+    spi_timing_model() - evaluate profile p into t.
+
+    A byte of the USCI/eUSCI is double buffered: the RX interrupt (or the
+    DMA) has one byte time to read UCzRXBUF and refill UCzTXBUF. The USI
+    shift register is not buffered, its interrupt runs in a pause the
+    master leaves between words, so SCK is only limited by the module.
+    Between frames the completion and the re-arm have to finish before
+    the next CS assert. A half-duplex turnaround is a re-arm within the
+    frame plus the switch of the data pin; the USI switches SDO with
+    USIOE only. A timeout adds no interrupt to a DMA frame, its start is
+    stamped from transactionDone() or poll() (spi_slave_set_frame_timer()),
+    so the DMA figures hold with and without one.
+*/
+static inline void spi_timing_model(const spi_timing_profile_t *p, spi_timing_t *t)
+{
+    uint32_t limit;
+    uint32_t sck;
+    uint32_t ns;
+    uint16_t body;
+    uint16_t arm;
+
+    t->byte_cycles = 0;
+    t->header_cycles = 0;
+    t->word_cycles = 0;
+    t->word_gap_ns = 0;
+    t->turn_cycles = 0;
+    t->turn_ns = 0;
+
+    if (p->module == SPI_TIMING_USI)
+    {
+        limit = SPI_TIMING_SCK_LIMIT_USI;
+        arm = SPI_TIMING_ARM_ISR;
+        t->word_cycles = SPI_TIMING_IRQ + SPI_TIMING_USI_WORD + SPI_TIMING_JITTER;
+        if (p->mode & SPI_TIMING_HEADER)
+        {
+            t->word_cycles += p->hook_cycles;
+        }
+        t->gap_cycles = SPI_TIMING_IRQ + SPI_TIMING_USI_WORD + SPI_TIMING_COMPLETE + arm + p->hook_cycles;
+        t->word_gap_ns = spi_timing_ns(t->word_cycles, p->mclk_hz);
+        if (p->mode & SPI_TIMING_HALF)
+        {
+            t->turn_cycles = SPI_TIMING_IRQ + SPI_TIMING_USI_WORD + arm + SPI_TIMING_JITTER + p->hook_cycles;
+        }
+    }
+    else if (p->mode & SPI_TIMING_DMA)
+    {
+        limit = (p->module == SPI_TIMING_EUSCI) ? SPI_TIMING_SCK_LIMIT_EUSCI : SPI_TIMING_SCK_LIMIT_USCI;
+        arm = SPI_TIMING_ARM_DMA;
+        t->byte_cycles = SPI_TIMING_DMA_BYTE + SPI_TIMING_DMA_WAIT;
+        if (p->mode & SPI_TIMING_HEADER)
+        {
+            /* the rest of the frame is armed while the next byte shifts in */
+            t->header_cycles = SPI_TIMING_IRQ + SPI_TIMING_DMA_HEADER + SPI_TIMING_JITTER + p->hook_cycles;
+        }
+        t->gap_cycles = SPI_TIMING_IRQ + SPI_TIMING_DMA_ISR + SPI_TIMING_COMPLETE + arm + p->hook_cycles;
+        if (p->mode & SPI_TIMING_HALF)
+        {
+            t->turn_cycles = SPI_TIMING_IRQ + SPI_TIMING_DMA_ISR + arm + SPI_TIMING_PIN + SPI_TIMING_JITTER + p->hook_cycles;
+            t->gap_cycles += SPI_TIMING_PIN;
+        }
+    }
+    else
+    {
+        limit = (p->module == SPI_TIMING_EUSCI) ? SPI_TIMING_SCK_LIMIT_EUSCI : SPI_TIMING_SCK_LIMIT_USCI;
+        arm = SPI_TIMING_ARM_ISR;
+        body = (p->mode & SPI_TIMING_RX_ONLY) ? SPI_TIMING_RX_ONLY_BYTE : SPI_TIMING_RX_BYTE;
+        t->byte_cycles = SPI_TIMING_IRQ + SPI_TIMING_DISPATCH + body + SPI_TIMING_JITTER;
+        if (p->mode & SPI_TIMING_HEADER)
+        {
+            t->header_cycles = t->byte_cycles + p->hook_cycles;
+        }
+        t->gap_cycles = SPI_TIMING_IRQ + SPI_TIMING_DISPATCH + body + SPI_TIMING_COMPLETE + arm + p->hook_cycles;
+        if (p->mode & SPI_TIMING_HALF)
+        {
+            t->turn_cycles = SPI_TIMING_IRQ + SPI_TIMING_DISPATCH + body + arm + SPI_TIMING_PIN + SPI_TIMING_JITTER + p->hook_cycles;
+            t->gap_cycles += SPI_TIMING_PIN;
+        }
+    }
+    if (p->mode & SPI_TIMING_CS_END)
+    {
+        t->gap_cycles = SPI_TIMING_IRQ + SPI_TIMING_ABORT + arm + p->hook_cycles;
+    }
+
+    t->sck_max_hz = limit;
+    sck = spi_timing_sck(t->byte_cycles, p->mclk_hz);
+    if (sck < t->sck_max_hz)
+    {
+        t->sck_max_hz = sck;
+    }
+    sck = spi_timing_sck(t->header_cycles, p->mclk_hz);
+    if (sck < t->sck_max_hz)
+    {
+        t->sck_max_hz = sck;
+    }
+    t->cs_gap_ns = spi_timing_ns(t->gap_cycles, p->mclk_hz);
+    if (t->turn_cycles)
+    {
+        t->turn_ns = spi_timing_ns(t->turn_cycles, p->mclk_hz);
+    }
+
+    /* frame time in ns: bits at sck_max_hz, USI word pauses, turnaround, CS gap */
+    ns = (uint32_t)p->frame * (8000000UL / (t->sck_max_hz / 1000UL + 1) + 1);
+    ns += (uint32_t)(p->frame / 2) * t->word_gap_ns + t->turn_ns + t->cs_gap_ns;
+    t->frames_per_s = (ns == 0) ? 0 : (1000000000UL / ns);
+}
+
+#endif /*_SPI_SLAVE_TIMING_H_*/
@@ -0,0 +1,131 @@
+/*
+    spi_slave_trace.cpp - transaction trace ring of the SPI Slave implementations
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+*/
+
+#include <stdint.h>
+#include <Energia.h>
+#include "spi_slave_trace.h"
+
+#if SPI_SLAVE_TRACE
+
+static spi_slave_trace_t trace[SPI_SLAVE_TRACE_DEPTH];
+static uint16_t trace_total = 0;    /* records started, wraps */
+static uint8_t trace_head = 0;      /* slot of the next record */
+static uint8_t trace_kept = 0;      /* valid records, saturates at the depth */
+static uint8_t trace_open = 0;      /* last record waits for its end */
+
+static spi_slave_trace_t *spi_slave_trace_last(void)
+{
+    return (&trace[(trace_head - 1) & (SPI_SLAVE_TRACE_DEPTH - 1)]);
+}
+
+/**
+    spi_slave_trace_start() - open a record for a transfer being armed.
+
+    A record still open is closed first, flagged SPI_TRACE_OPEN: without
+    events the DMA completion is not seen in interrupt context. Arming
+    from loop() races the end of the previous frame, so the ring is
+    updated with interrupts off.
+*/
+void spi_slave_trace_start(uint16_t count, uint8_t flags)
+{
+    spi_slave_trace_t *t;
+    uint16_t sr;
+
+    sr = __get_SR_register();
+    __disable_interrupt();
+    if (trace_open)
+    {
+        spi_slave_trace_end(0, 0, SPI_TRACE_OPEN);
+    }
+    t = &trace[trace_head];
+    t->start = micros();
+    t->duration = 0;
+    t->count = count;
+    t->received = 0;
+    t->flags = flags;
+    t->seq = trace_total;
+    trace_total++;
+    trace_head = (trace_head + 1) & (SPI_SLAVE_TRACE_DEPTH - 1);
+    if (trace_kept < SPI_SLAVE_TRACE_DEPTH)
+    {
+        trace_kept++;
+    }
+    trace_open = 1;
+    __bis_SR_register(sr & GIE);
+}
+
+/**
+    spi_slave_trace_end() - close the open record, interrupt context.
+
+    rx is the start of the receive buffer, 0 if its bytes are not valid.
+*/
+void spi_slave_trace_end(uint16_t received, const uint8_t *rx, uint8_t flags)
+{
+    spi_slave_trace_t *t;
+    uint32_t duration;
+    uint8_t i;
+
+    if (!trace_open)
+    {
+        return;
+    }
+    trace_open = 0;
+    t = spi_slave_trace_last();
+    duration = micros() - t->start;
+    t->duration = (duration > 0xFFFF) ? 0xFFFF : duration;
+    t->received = received;
+    t->flags |= flags;
+    for (i = 0; i < SPI_SLAVE_TRACE_BYTES; i++)
+    {
+        t->data[i] = (rx && (i < received)) ? rx[i] : 0;
+    }
+}
+
+/**
+    spi_slave_trace_read() - copy a record, index 0 is the oldest one kept.
+
+    Returns 0 when there is no such record.
+*/
+uint8_t spi_slave_trace_read(uint8_t index, spi_slave_trace_t *record)
+{
+    uint8_t found = 0;
+    uint16_t sr;
+
+    sr = __get_SR_register();
+    __disable_interrupt();
+    /* head and kept move together with the record in interrupt context */
+    if (index < trace_kept)
+    {
+        *record = trace[(trace_head - trace_kept + index) & (SPI_SLAVE_TRACE_DEPTH - 1)];
+        found = 1;
+    }
+    __bis_SR_register(sr & GIE);
+    return (found);
+}
+
+uint16_t spi_slave_trace_count(void)
+{
+    return (trace_total);
+}
+
+void spi_slave_trace_clear(void)
+{
+    uint16_t sr;
+
+    sr = __get_SR_register();
+    __disable_interrupt();
+    trace_total = 0;
+    trace_head = 0;
+    trace_kept = 0;
+    trace_open = 0;
+    __bis_SR_register(sr & GIE);
+}
+
+#endif
@@ -0,0 +1,71 @@
+/*
+    spi_slave_trace.h - transaction trace ring of the SPI Slave implementations
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+    Every armed transfer gets one fixed size binary record; the backends
+    fill it in at arm time and when the transfer completes or is aborted.
+    Set SPI_SLAVE_TRACE to 1 in spi_slave_config.h to compile the trace
+    in, it costs nothing when it is 0.
+
+*/
+
+#ifndef _SPI_SLAVE_TRACE_H_
+#define _SPI_SLAVE_TRACE_H_
+
+#include <stdint.h>
+#include "spi_slave_config.h"
+
+#ifndef SPI_SLAVE_TRACE_DEPTH
+#define SPI_SLAVE_TRACE_DEPTH 16    /* records, power of two up to 128 */
+#endif
+#if (SPI_SLAVE_TRACE_DEPTH & (SPI_SLAVE_TRACE_DEPTH - 1)) || (SPI_SLAVE_TRACE_DEPTH > 128)
+#error "SPI_SLAVE_TRACE_DEPTH must be a power of two up to 128"
+#endif
+#ifndef SPI_SLAVE_TRACE_BYTES
+#define SPI_SLAVE_TRACE_BYTES 4     /* leading RX bytes kept per record */
+#endif
+
+/* record flags */
+#define SPI_TRACE_DMA      0x01    /* transfer ran on DMA, else on the RX interrupt */
+#define SPI_TRACE_RX_ONLY  0x02    /* receive(), dummy bytes sent */
+#define SPI_TRACE_HEADER   0x04    /* frame length set by the header hook */
+#define SPI_TRACE_ECHO     0x08
+#define SPI_TRACE_DONE     0x10    /* completion seen in interrupt context */
+#define SPI_TRACE_ABORT    0x20    /* spi_slave_abort() */
+#define SPI_TRACE_OPEN     0x40    /* re-armed before the completion was seen */
+#define SPI_TRACE_STREAM   0x80    /* stream(), count is the ring size */
+
+typedef struct
+{
+    uint32_t start;       /* micros() when armed */
+    uint16_t duration;    /* micros() from arm to end, 0xFFFF if longer */
+    uint16_t count;       /* requested bytes */
+    uint16_t received;    /* bytes received */
+    uint8_t  flags;       /* SPI_TRACE_xxx */
+    uint8_t  seq;         /* record number, low byte */
+    uint8_t  data[SPI_SLAVE_TRACE_BYTES];
+} spi_slave_trace_t;
+
+#if SPI_SLAVE_TRACE
+
+void spi_slave_trace_start(uint16_t count, uint8_t flags);
+void spi_slave_trace_end(uint16_t received, const uint8_t *rx, uint8_t flags);
+uint8_t spi_slave_trace_read(uint8_t index, spi_slave_trace_t *record);
+uint16_t spi_slave_trace_count(void);
+void spi_slave_trace_clear(void);
+
+#define SPI_TRACE_START(count, flags)       spi_slave_trace_start((count), (flags))
+#define SPI_TRACE_END(received, rx, flags)  spi_slave_trace_end((received), (rx), (flags))
+
+#else
+
+#define SPI_TRACE_START(count, flags)
+#define SPI_TRACE_END(received, rx, flags)
+
+#endif
+
+#endif /*_SPI_SLAVE_TRACE_H_*/
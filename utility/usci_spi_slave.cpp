@@ -11,18 +11,50 @@
     or the GNU Lesser General Public License version 2.1, both as
     published by the Free Software Foundation.
 
+    Only the USCI specific part is here: module addresses, DMA triggers
+    and the mode setup. Transfers, hooks and interrupt handlers are shared
+    with the other family in spi_slave_common.cpp.
+
 */
 
 #include <msp430.h>
 #include <stdint.h>
-#include "spi_slave_430.h"
+#include "spi_slave_common.h"
 #include <Energia.h>
 #include "usci_isr_handler.h"
 
 #if defined(__MSP430_HAS_USCI_B0__) || defined(__MSP430_HAS_USCI_B1__) || defined(__MSP430_HAS_USCI__)
-#ifndef __data16_write_addr
-#define __data16_write_addr(x,y) *(unsigned long int*)(x) = y
+
+
+#if defined(DEFAULT_SPI)
+#if (DEFAULT_SPI == 0)
+uint16_t SPI_slave_baseAddress = UCB0_BASE;
+#endif
+#if (DEFAULT_SPI == 1)
+uint16_t SPI_slave_baseAddress = UCB1_BASE;
+#endif
+#if (DEFAULT_SPI == 2)
+uint16_t SPI_slave_baseAddress = UCB2_BASE;
+#endif
+#if (DEFAULT_SPI == 3)
+uint16_t SPI_slave_baseAddress = UCB3_BASE;
+#endif
+#if (DEFAULT_SPI == 10)
+uint16_t SPI_slave_baseAddress = UCA0_BASE;
 #endif
+#if (DEFAULT_SPI == 11)
+uint16_t SPI_slave_baseAddress = UCA1_BASE;
+#endif
+#if (DEFAULT_SPI == 12)
+uint16_t SPI_slave_baseAddress = UCA2_BASE;
+#endif
+#if (DEFAULT_SPI == 13)
+uint16_t SPI_slave_baseAddress = UCA3_BASE;
+#endif
+#else
+uint16_t SPI_slave_baseAddress = UCB0_BASE;
+#endif
+
 
 #if defined(DEFAULT_SPI)
 uint8_t spiSlaveModule = DEFAULT_SPI;
@@ -30,7 +62,6 @@ uint8_t spiSlaveModule = DEFAULT_SPI;
 uint8_t spiSlaveModule = 0;
 #endif
 
-
 /**
     USCI flags for various the SPI MODEs
 
@@ -46,52 +77,138 @@ uint8_t spiSlaveModule = 0;
 
 #define SPI_MODE_MASK (UCCKPL | UCCKPH)
 
-uint8_t * rxptr;
-uint8_t * txptr;
-uint16_t rxcount = 0;
-uint16_t txcount = 0;
-uint16_t rxrecived = 0;
-uint8_t com_mode = 0; /* mode : 0 - RX and TX  1 - RX only, TX to dummy */
-#define COM_MODE_RX  0x1
-#define COM_MODE_DMA 0x2
-
-const uint8_t dummy = 0xFF;
-
 /**
-    spi_slave_initialize() - Configure USCI UCB0 for SPI mode
-
-    Pxx - CS (active low)
-    Pxx - SCLK
-    Pxx - MISO aka SOMI
-    Pxx - MOSI aka SIMO
-
+    DMA triggers of the USCI modules, see the module map in spi_slave_common.h.
 */
 
-void spi_slave_initialize(const uint8_t mode, const uint8_t datamode, const uint8_t order)
+#if defined(__MSP430_HAS_USCI__) && (SPI_SLAVE_HAS_DMA == 2)
+/* F2xx headers only name the raw numbers: UCB0RXIFG 12, UCB0TXIFG 13 */
+#define UCB0_DMA   0, 12, 13
+#elif defined(DMA0TSEL__USCIB0RX) && defined(DMA1TSEL__USCIB0TX)
+#define UCB0_DMA   0, DMA0TSEL__USCIB0RX, DMA1TSEL__USCIB0TX
+#else
+#define UCB0_DMA   SPI_DMA_NONE, 0, 0
+#endif
+#if defined(DMA0TSEL__USCIB1RX) && defined(DMA1TSEL__USCIB1TX)
+#define UCB1_DMA   0, DMA0TSEL__USCIB1RX, DMA1TSEL__USCIB1TX
+#else
+#define UCB1_DMA   SPI_DMA_NONE, 0, 0
+#endif
+#if defined(DMA0TSEL__USCIB2RX) && defined(DMA1TSEL__USCIB2TX)
+#define UCB2_DMA   0, DMA0TSEL__USCIB2RX, DMA1TSEL__USCIB2TX
+#else
+#define UCB2_DMA   SPI_DMA_NONE, 0, 0
+#endif
+#if defined(DMA0TSEL__USCIB3RX) && defined(DMA1TSEL__USCIB3TX)
+#define UCB3_DMA   0, DMA0TSEL__USCIB3RX, DMA1TSEL__USCIB3TX
+#else
+#define UCB3_DMA   SPI_DMA_NONE, 0, 0
+#endif
+#if defined(__MSP430_HAS_USCI__) && (SPI_SLAVE_HAS_DMA == 2)
+/* UCA0RXIFG 3, UCA0TXIFG 4 */
+#define UCA0_DMA   0, 3, 4
+#elif defined(DMA0TSEL__USCIA0RX) && defined(DMA1TSEL__USCIA0TX)
+#define UCA0_DMA   0, DMA0TSEL__USCIA0RX, DMA1TSEL__USCIA0TX
+#else
+#define UCA0_DMA   SPI_DMA_NONE, 0, 0
+#endif
+#if defined(DMA0TSEL__USCIA1RX) && defined(DMA1TSEL__USCIA1TX)
+#define UCA1_DMA   0, DMA0TSEL__USCIA1RX, DMA1TSEL__USCIA1TX
+#else
+#define UCA1_DMA   SPI_DMA_NONE, 0, 0
+#endif
+#if defined(DMA0TSEL__USCIA2RX) && defined(DMA1TSEL__USCIA2TX)
+#define UCA2_DMA   0, DMA0TSEL__USCIA2RX, DMA1TSEL__USCIA2TX
+#else
+#define UCA2_DMA   SPI_DMA_NONE, 0, 0
+#endif
+#if defined(DMA0TSEL__USCIA3RX) && defined(DMA1TSEL__USCIA3TX)
+#define UCA3_DMA   0, DMA0TSEL__USCIA3RX, DMA1TSEL__USCIA3TX
+#else
+#define UCA3_DMA   SPI_DMA_NONE, 0, 0
+#endif
+
+const spi_slave_module_t spi_slave_modules[] =
 {
+#if defined(UCB0_BASE) && SPI_SLAVE_MODULE_USED(0)
+    SPI_SLAVE_MODULE(0, UCB0_BASE, UCB0_DMA),
+#endif
+#if defined(UCB1_BASE) && SPI_SLAVE_MODULE_USED(1)
+    SPI_SLAVE_MODULE(1, UCB1_BASE, UCB1_DMA),
+#endif
+#if defined(UCB2_BASE) && SPI_SLAVE_MODULE_USED(2)
+    SPI_SLAVE_MODULE(2, UCB2_BASE, UCB2_DMA),
+#endif
+#if defined(UCB3_BASE) && SPI_SLAVE_MODULE_USED(3)
+    SPI_SLAVE_MODULE(3, UCB3_BASE, UCB3_DMA),
+#endif
+#if defined(UCA0_BASE) && SPI_SLAVE_MODULE_USED(10)
+    SPI_SLAVE_MODULE(10, UCA0_BASE, UCA0_DMA),
+#endif
+#if defined(UCA1_BASE) && SPI_SLAVE_MODULE_USED(11)
+    SPI_SLAVE_MODULE(11, UCA1_BASE, UCA1_DMA),
+#endif
+#if defined(UCA2_BASE) && SPI_SLAVE_MODULE_USED(12)
+    SPI_SLAVE_MODULE(12, UCA2_BASE, UCA2_DMA),
+#endif
+#if defined(UCA3_BASE) && SPI_SLAVE_MODULE_USED(13)
+    SPI_SLAVE_MODULE(13, UCA3_BASE, UCA3_DMA),
+#endif
+};
 
-    /*  Calling this dummy function prevents the linker
-        from stripping the USCI interupt vectors.*/
-    usci_isr_install();
+const uint8_t spi_slave_module_count = sizeof(spi_slave_modules) / sizeof(spi_slave_modules[0]);
 
-    /* Put USCI in reset mode, source USCI clock from SMCLK. */
-    UCB0CTL1 = UCSWRST;
+#if SPI_SLAVE_DMA
+/* every module of the device, SPI_SLAVE_ONLY_MODULE limits the slave only */
+const spi_slave_module_t spi_master_modules[] =
+{
+#if defined(UCB0_BASE)
+    SPI_SLAVE_MODULE(0, UCB0_BASE, UCB0_DMA),
+#endif
+#if defined(UCB1_BASE)
+    SPI_SLAVE_MODULE(1, UCB1_BASE, UCB1_DMA),
+#endif
+#if defined(UCB2_BASE)
+    SPI_SLAVE_MODULE(2, UCB2_BASE, UCB2_DMA),
+#endif
+#if defined(UCB3_BASE)
+    SPI_SLAVE_MODULE(3, UCB3_BASE, UCB3_DMA),
+#endif
+#if defined(UCA0_BASE)
+    SPI_SLAVE_MODULE(10, UCA0_BASE, UCA0_DMA),
+#endif
+#if defined(UCA1_BASE)
+    SPI_SLAVE_MODULE(11, UCA1_BASE, UCA1_DMA),
+#endif
+#if defined(UCA2_BASE)
+    SPI_SLAVE_MODULE(12, UCA2_BASE, UCA2_DMA),
+#endif
+#if defined(UCA3_BASE)
+    SPI_SLAVE_MODULE(13, UCA3_BASE, UCA3_DMA),
+#endif
+};
 
-    /* SPI in slave MODE 0 - CPOL=0 SPHA=0. - 3 wire STE */
-    UCB0CTL0 = SPI_MODE_0 | UCMSB | UCSYNC;  // Use SPI MODE 0 - CPOL=0 CPHA=0 - 4 wire STE = 1
+const uint8_t spi_master_module_count = sizeof(spi_master_modules) / sizeof(spi_master_modules[0]);
+#endif
 
-    UCB0CTL0 = (UCB0CTL0 & ~UCMSB) | ((order == 1 /*MSBFIRST*/) ? UCMSB : 0); /* MSBFIRST = 1 */
+/* UCzCTL0 bits for wire mode, SPI mode and bit order */
+static uint8_t spi_slave_ctl_bits(const uint8_t mode, const uint8_t datamode, const uint8_t order)
+{
+    uint8_t bits = (order == 1 /*MSBFIRST*/) ? UCMSB : 0; /* MSBFIRST = 1 */
 
     switch (mode)
     {
         case 0: /* 3 wire  */
-            UCB0CTL0 |= UCMODE_0;
+            bits |= UCMODE_0;
             break;
         case 1: /* 4 wire STE = 1 */
-            UCB0CTL0 |= UCMODE_1;
+            bits |= UCMODE_1;
             break;
         case 2: /* 4 wire STE = 0 */
-            UCB0CTL0 |= UCMODE_2;
+            bits |= UCMODE_2;
+            break;
+        case 3: /* 3 wire, one data line */
+            bits |= UCMODE_0;
             break;
         default:
             break;
@@ -100,203 +217,78 @@ void spi_slave_initialize(const uint8_t mode, const uint8_t datamode, const uint
     switch (datamode)
     {
         case 0: /* SPI_MODE0 */
-            UCB0CTL0 |= SPI_MODE_0;
+            bits |= SPI_MODE_0;
             break;
         case 1: /* SPI_MODE1 */
-            UCB0CTL0 |= SPI_MODE_1;
+            bits |= SPI_MODE_1;
             break;
         case 2: /* SPI_MODE2 */
-            UCB0CTL0 |= SPI_MODE_2;
+            bits |= SPI_MODE_2;
             break;
         case 3: /* SPI_MODE3 */
-            UCB0CTL0 |= SPI_MODE_3;
+            bits |= SPI_MODE_3;
             break;
         default:
             break;
     }
-#if defined(DMA_BASE)
-    com_mode = COM_MODE_DMA;
-#else
-    com_mode = 0;
-#endif
-#if defined(DMA_BASE) && defined(DMA0TSEL__USCIB0RX) && defined(DMA1TSEL__USCIB0RX)
-    if (com_mode & COM_MODE_DMA)
-    {
-        DMACTL0 = (DMACTL0 & ~DMA0TSEL__DMAE0) | DMA0TSEL__USCIB0RX;
-        __data16_write_addr((unsigned short)(&DMA0SA), (unsigned long)&UCB0RXBUF);
-
-        DMACTL0 = (DMACTL0 & ~DMA1TSEL__DMAE0) | DMA1TSEL__USCIB0TX;
-        __data16_write_addr((unsigned short)(&DMA1DA), (unsigned long)&UCB0TXBUF);
-    }
-#endif
-
-    /* Release USCI for operation. */
-    UCB0CTL1 &= ~UCSWRST;                // release USCI for operation
-}
-
-
-/**
-    spi_slave_disable() - put USCI into reset mode.
-*/
-void spi_slave_disable(void)
-{
-    /* Wait for previous tx to complete. */
-    while (UCB0STAT & UCBUSY);
-    /* Put USCI in reset mode. */
-    UCB0CTL1 |= UCSWRST;
+    return (bits);
 }
 
 /**
-    spi_slave_transfer() - send a bytes and recv response.
-*/
+    spi_slave_initialize() - Configure USCI UCz for SPI mode
 
-void spi_slave_transfer(uint8_t *rxbuf, uint8_t *txbuf, uint16_t count)
-{
-    rxcount = count;
-    txcount = count;
-    rxrecived = 0;
-#ifdef DMA_BASE
-    if (com_mode & COM_MODE_DMA)
-    {
-        DMA0CTL = 0;
-        DMA1CTL = 0;
-        /* Toggle USCI reset mode to flush TX pipe */
-        UCB0CTL1 |= UCSWRST;
-        UCB0CTL1 &= ~UCSWRST;
-        // RXIFG
-        __data16_write_addr((unsigned short)(&DMA0DA), (unsigned long)rxbuf);
-        DMA0SZ  = count;
-        DMA0CTL = DMADT_0 + DMADSTINCR_3 + DMASBDB + DMALEVEL + DMAEN;
-
-        //TXIFG;
-        __data16_write_addr((unsigned short)(&DMA1SA), (unsigned long)txbuf);
-        DMA1SZ  = count;
-        DMA1CTL = DMADT_0 + DMASRCINCR_3 + DMASBDB + DMALEVEL + DMAEN;
-    }
-    else
-#endif
-    {
-        rxptr = rxbuf;
-        txptr = txbuf;
-        com_mode &= ~COM_MODE_RX;
-        while ((UCB0IFG & UCTXIFG) && txcount)
-        {
-            *(&(UCB0TXBUF)) = *txptr++;  /* put in first character */
-            txcount--;
-        }
-        UCB0IE |= UCRXIE;  /* need to receive data to transmit */
-    }
-}
+    Pxx - CS (active low)
+    Pxx - SCLK
+    Pxx - MISO aka SOMI
+    Pxx - MOSI aka SIMO
 
-/**
-    spi_slave_receive() - send a bytes.
 */
-void spi_slave_receive(uint8_t *buf, uint16_t count)
-{
-    rxcount = count;
-    txcount = count;
-    rxrecived = 0;
-#ifdef DMA_BASE
-    if (com_mode & COM_MODE_DMA)
-    {
-        DMA0CTL = 0;
-        DMA1CTL = 0;
-        /* Toggle USCI reset mode to flush TX pipe */
-        UCB0CTL1 |= UCSWRST;
-        UCB0CTL1 &= ~UCSWRST;
-        // RXIFG
-        __data16_write_addr((unsigned short)(DMA0DA), (unsigned long)buf);
-        DMA0SZ  = count;
-        DMA0CTL = DMADT_0 + DMADSTINCR_3 + DMASBDB + DMALEVEL + DMAEN;
-
-        //TXIFG;
-        __data16_write_addr((unsigned short)(DMA1SA), (unsigned long)&dummy);
-        DMA1SZ  = count;
-        DMA1CTL = DMADT_0 + DMASBDB + DMALEVEL + DMAEN;
-    }
-    else
-#endif
-    {
-        rxptr = buf;
-        txptr = (uint8_t *) &dummy;
-        com_mode |= COM_MODE_RX;
-        while ((UCB0IFG & UCTXIFG))
-        {
-            *(&(UCB0TXBUF)) = dummy;  /* put in first characters */
-        }
-        UCB0IE |= UCRXIE;  /* need to receive data to transmit */
-    }
-}
 
-int spi_bytes_to_transmit(void)
+void spi_slave_initialize(const uint8_t mode, const uint8_t datamode, const uint8_t order)
 {
-#ifdef DMA_BASE
-    // when DMA enabled return DMAxSZ else done return 0
-    return ((DMA1CTL & DMAEN) ? DMA1SZ : 0);
-#else
-    return (txcount);
-#endif
-}
-
+    /*  Calling this dummy function prevents the linker
+        from stripping the USCI interupt vectors.*/
+    usci_isr_install();
 
-int spi_bytes_received(void)
-{
-#ifdef DMA_BASE
-    // when DMA enabled return DMAxSZ else done return 0
-    if (com_mode & COM_MODE_DMA)
-    {
-        return ((DMA0CTL & DMAEN) ? (rxcount - DMA0SZ) : rxcount);
-    }
-    else
-    {
-        return (rxrecived);
-    }
-#else
-    return (rxrecived);
-#endif
-}
+    /* Put USCI in reset mode, source USCI clock from SMCLK. */
+    UCzCTL1 = UCSWRST;
 
+    /* SPI slave, synchronous mode */
+    UCzCTL0 = UCSYNC | spi_slave_ctl_bits(mode, datamode, order);
+    spi_slave_setup(mode);
 
-int spi_data_done(void)
-{
-#ifdef DMA_BASE
-    return (!(DMA0CTL & DMAEN));
-#else
-    return (rxcount == 0);
-#endif
+    /* Release USCI for operation. */
+    UCzCTL1 &= ~UCSWRST;
 }
 
+/**
+    spi_slave_reconfigure() - change wire mode, SPI mode and bit order.
 
-void spi_rx_isr(uint8_t offset)
+    Only the mode fields of UCzCTL0 are rewritten, under UCSWRST; DMA setup,
+    interrupt enables and pins are kept, so no full begin() is needed.
+    Call it between frames: the byte preloaded into UCzTXBUF is lost, arm
+    the next transfer afterwards. Returns 1 if the wire mode changed.
+*/
+uint8_t spi_slave_reconfigure(const uint8_t mode, const uint8_t datamode, const uint8_t order)
 {
-    uint8_t temp;
-    temp = *txptr; // store in case tx and rx ptr are identical
-    if (rxcount)
-    {
-        if (rxptr != 0)
-        {
-            *rxptr++ = *(&(UCB0RXBUF));
-            rxcount--;
-            rxrecived++;
-        }
-    }
-    else
+    uint8_t mask = UCMSB | UCMODE_3 | SPI_MODE_MASK;
+    uint8_t bits = spi_slave_ctl_bits(mode, datamode, order);
+    uint8_t ctl = UCzCTL0;
+    uint8_t half = half_wire;
+    uint8_t ie;
+
+    half_wire = (mode == 3);
+    if ((ctl & mask) == bits)
     {
-        UCB0IE &= ~UCRXIE;  /* disable interrupt */
-    }
-    if (txcount)
-    {
-        if (txptr != 0)
-        {
-            *(&(UCB0TXBUF)) = temp;
-            if ((com_mode & COM_MODE_RX) == 0)
-            {
-                txptr++;
-            }
-            txcount--;
-        }
+        return (half != half_wire);
     }
+    ie = UCzIE;
+    UCzCTL1 |= UCSWRST;
+    UCzCTL0 = (ctl & ~mask) | bits;
+    UCzCTL1 &= ~UCSWRST;
+    UCzIE = ie;  /* UCSWRST clears the interrupt enables */
+    return ((((ctl ^ bits) & UCMODE_3) != 0) || (half != half_wire));
 }
 
-#endif
 
+#endif
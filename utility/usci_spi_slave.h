@@ -0,0 +1,82 @@
+/*
+    usci_spi_slave.h - register access of the msp430 USCI SPI Slave implementation
+
+    USCI flavor implementation by StefanSch
+    based on:
+    Copyright (c) 2012 by Rick Kimball <rick@kimballsoftware.com>
+    spi slave abstraction api for msp430
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+    Internal to the library, included through spi_slave_common.h.
+
+*/
+
+#ifndef _USCI_SPI_SLAVE_H_
+#define _USCI_SPI_SLAVE_H_
+
+#if defined(__MSP430_HAS_USCI_B0__)
+#define UCB0_BASE __MSP430_BASEADDRESS_USCI_B0__
+#endif
+#if defined(__MSP430_HAS_USCI_B1__)
+#define UCB1_BASE __MSP430_BASEADDRESS_USCI_B1__
+#endif
+#if defined(__MSP430_HAS_USCI_B2__)
+#define UCB2_BASE __MSP430_BASEADDRESS_USCI_B2__
+#endif
+#if defined(__MSP430_HAS_USCI_B3__)
+#define UCB3_BASE __MSP430_BASEADDRESS_USCI_B3__
+#endif
+
+#if defined(__MSP430_HAS_USCI_A0__)
+#define UCA0_BASE __MSP430_BASEADDRESS_USCI_A0__
+#endif
+#if defined(__MSP430_HAS_USCI_A1__)
+#define UCA1_BASE __MSP430_BASEADDRESS_USCI_A1__
+#endif
+#if defined(__MSP430_HAS_USCI_A2__)
+#define UCA2_BASE __MSP430_BASEADDRESS_USCI_A2__
+#endif
+#if defined(__MSP430_HAS_USCI_A3__)
+#define UCA3_BASE __MSP430_BASEADDRESS_USCI_A3__
+#endif
+
+#if defined(__MSP430_HAS_USCI__)
+/* 2xx USCI has no base address macros, address the modules by UCxxCTL0 */
+#define UCA0_BASE 0x0060
+#define UCB0_BASE 0x0068
+#endif
+
+#if defined(__MSP430_HAS_USCI__)
+/* 2xx USCI_A0 and USCI_B0 share one layout, interrupt enables and flags live in IE2/IFG2 */
+#define UCzCTL0      HWREG8(0x0000 + SPI_slave_baseAddress)
+#define UCzCTL1      HWREG8(0x0001 + SPI_slave_baseAddress)
+#define UCzSTAT      HWREG8(0x0005 + SPI_slave_baseAddress)
+#define OFS_UCzRXBUF 0x0006
+#define OFS_UCzTXBUF 0x0007
+#define UCzIFG       IFG2
+#define UCzIE        IE2
+#define UCRXIE       ((SPI_slave_baseAddress == UCB0_BASE) ? UCB0RXIE : UCA0RXIE)
+#define UCRXIFG      ((SPI_slave_baseAddress == UCB0_BASE) ? UCB0RXIFG : UCA0RXIFG)
+#define UCTXIFG      ((SPI_slave_baseAddress == UCB0_BASE) ? UCB0TXIFG : UCA0TXIFG)
+#define UCTXIE       ((SPI_slave_baseAddress == UCB0_BASE) ? UCB0TXIE : UCA0TXIE)
+#else
+/* F5xx/F6xx USCI_Ax and USCI_Bx share one register layout in SPI mode */
+#define UCzCTL0      HWREG8(OFS_UCB0CTL0 + SPI_slave_baseAddress)
+#define UCzCTL1      HWREG8(OFS_UCB0CTL1 + SPI_slave_baseAddress)
+#define UCzSTAT      HWREG8(OFS_UCB0STAT + SPI_slave_baseAddress)
+#define OFS_UCzRXBUF OFS_UCB0RXBUF
+#define OFS_UCzTXBUF OFS_UCB0TXBUF
+#define UCzIFG       HWREG8(OFS_UCB0IFG  + SPI_slave_baseAddress)
+#define UCzIE        HWREG8(OFS_UCB0IE   + SPI_slave_baseAddress)
+#endif
+#define UCzRXBUF     HWREG8(OFS_UCzRXBUF + SPI_slave_baseAddress)
+#define UCzTXBUF     HWREG8(OFS_UCzTXBUF + SPI_slave_baseAddress)
+
+/* names shared with the eUSCI backend */
+#define UCzSWRST     UCzCTL1     /* register holding UCSWRST */
+
+#endif /*_USCI_SPI_SLAVE_H_*/
@@ -0,0 +1,991 @@
+/**
+    File: usi_spi_slave.c - msp430 USI SPI Slave implementation
+
+    USI flavor of the SPI slave abstraction api for msp430
+    based on:
+    Copyright (c) 2012 by Rick Kimball <rick@kimballsoftware.com>
+    spi slave abstraction api for msp430
+
+    This file is free software; you can redistribute it and/or modify
+    it under the terms of either the GNU General Public License version 2
+    or the GNU Lesser General Public License version 2.1, both as
+    published by the Free Software Foundation.
+
+    The USI has no receive or transmit buffer: the next word can only be
+    loaded once the counter interrupt has fired for the previous one. The
+    shift register runs in 16 bit mode, so the interrupt comes every second
+    byte; the master has to leave the interrupt latency (about 40 MCLK
+    cycles) between 16 bit words. There is no hardware STE either, frames
+    are delimited by the byte count only and SDO is driven while enabled.
+
+*/
+
+#include <msp430.h>
+#include <stdint.h>
+#include "spi_slave_430.h"
+#include "spi_slave_trace.h"
+#include "spi_slave_stats.h"
+#include <Energia.h>
+
+#if defined(__MSP430_HAS_USI__)
+
+/* single module with fixed pins, kept for the common interface */
+uint16_t SPI_slave_baseAddress = 0;
+uint8_t spiSlaveModule = 0;
+
+/**
+    USI flags for various the SPI MODEs
+
+    Note: USICKPL (in USICKCTL) tracks the CPOL value. USICKPH (in USICTL1)
+    is inverted when compared to the CPHA value described in Motorola
+    documentation, like UCCKPH on the USCI.
+*/
+
+#define SPI_MODE_0_PH (USICKPH)            /* CPOL=0 CPHA=0 */
+#define SPI_MODE_1_PH (0)                  /* CPOL=0 CPHA=1 */
+#define SPI_MODE_2_PH (USICKPH)            /* CPOL=1 CPHA=0 */
+#define SPI_MODE_3_PH (0)                  /* CPOL=1 CPHA=1 */
+
+uint8_t * rxptr;
+uint8_t * txptr;
+uint16_t rxcount = 0;
+uint16_t txcount = 0;
+uint16_t rxrecived = 0;
+uint8_t com_mode = 0; /* mode : 0 - RX and TX  1 - RX only, TX to dummy */
+#define COM_MODE_RX  0x1
+#if SPI_SLAVE_ECHO
+#define COM_MODE_ECHO 0x4
+#else
+#define COM_MODE_ECHO 0   /* echo tests fold away */
+#endif
+#if SPI_SLAVE_HOOKS
+#define COM_MODE_HEADER 0x8 /* header of the current transfer not yet passed to the header hook */
+#else
+#define COM_MODE_HEADER 0
+#endif
+#if SPI_SLAVE_STREAM
+#define COM_MODE_STREAM 0x10 /* stream(): endless receive into a ring */
+#else
+#define COM_MODE_STREAM 0
+#endif
+#if SPI_SLAVE_HALF_DUPLEX
+#define COM_MODE_HALF 0x20 /* halfDuplex() command phase, the turnaround follows */
+#define COM_MODE_TURN 0x40 /* halfDuplex() response phase, SDO drives */
+#else
+#define COM_MODE_HALF 0
+#define COM_MODE_TURN 0
+#endif
+
+uint8_t usi_lsb = 0;  /* LSB first: the first byte is in USISRL */
+uint8_t wire_mode = 0; /* only reported back, the USI has no STE */
+
+#if SPI_SLAVE_DIRECTION == SPI_SLAVE_RX_ONLY
+#define SPI_TX_STEP 0     /* TX pointer stays on the dummy byte */
+#else
+#define SPI_TX_STEP ((com_mode & COM_MODE_RX) == 0)
+#endif
+
+uint8_t echo_xor = 0; /* echo mode: byte sent back = (received ^ echo_xor) + echo_add */
+uint8_t echo_add = 0;
+
+uint8_t * stream_end;          /* stream mode: rxptr wraps to rxstart here */
+uint16_t stream_size = 0;
+volatile uint32_t stream_laps = 0; /* completed passes over the ring */
+
+#if SPI_SLAVE_HALF_DUPLEX
+uint8_t * half_txbuf;          /* response, sent after the turnaround */
+uint16_t half_tx = 0;
+uint16_t half_rx = 0;          /* command length, reported from the turnaround on */
+#if SPI_SLAVE_HOOKS
+uint16_t (*turn_hook)(uint8_t *command) = 0;
+#else
+#define turn_hook ((uint16_t (*)(uint8_t *))0)
+#endif
+#endif
+
+uint8_t * rxstart;    /* start of the current receive buffer */
+uint16_t header_len = 0;
+#if SPI_SLAVE_HOOKS
+uint16_t (*header_hook)(uint8_t *header) = 0;
+void (*done_hook)(uint16_t received) = 0;
+uint8_t (*status_hook)(void) = 0;
+#else
+/* constant null hooks, the compiler drops every branch using them */
+#define header_hook ((uint16_t (*)(uint8_t *))0)
+#define done_hook   ((void (*)(uint16_t))0)
+#define status_hook ((uint8_t (*)(void))0)
+#endif
+
+volatile uint8_t *ready_out = 0;  /* PxOUT of the ready pin, 0 if unused */
+uint8_t ready_mask = 0;
+uint8_t ready_level = HIGH;
+
+const uint8_t dummy = 0xFF;
+static uint8_t quiet = 0; /* armed by spi_slave_probe(): not a frame, not traced or counted */
+
+#define ARM_NONE     0     /* echo, stream or half-duplex, not re-armed */
+#define ARM_TRANSFER 1
+#define ARM_RECEIVE  2
+#define ARM_PROBE    3
+static uint8_t arm_kind = ARM_NONE;  /* last armed transfer, see spi_slave_rearm() */
+static uint8_t * arm_rx;
+static uint8_t * arm_tx;
+static uint16_t arm_count;
+
+static uint8_t frame_timer = 0;      /* time the first byte of each frame */
+static volatile uint8_t frame_begun = 0;
+static volatile uint32_t frame_ms;   /* millis() at the first byte */
+
+static void spi_slave_ready(uint8_t armed)
+{
+    if (ready_out)
+    {
+        if ((armed != 0) == (ready_level == HIGH))
+        {
+            *ready_out |= ready_mask;
+        }
+        else
+        {
+            *ready_out &= ~ready_mask;
+        }
+    }
+}
+
+static void spi_slave_complete(uint16_t received)
+{
+    spi_slave_ready(0);
+    if (!quiet)
+    {
+        SPI_TRACE_END(received, rxstart, SPI_TRACE_DONE);
+        SPI_STATS_END(received);
+    }
+    if (done_hook)
+    {
+        done_hook(received);
+    }
+}
+
+/* Next byte of the TX buffer, dummy once it is used up. */
+static uint8_t spi_slave_next_tx(void)
+{
+    uint8_t data = dummy;
+    if (txcount)
+    {
+        data = *txptr;
+        if (SPI_TX_STEP)
+        {
+            txptr++;
+        }
+        txcount--;
+    }
+    return (data);
+}
+
+/* Load one word (two bytes) or, for the odd last byte, one byte and start the counter. */
+static void spi_slave_shift(uint8_t first, uint8_t second, uint8_t bits)
+{
+    if (bits == 16)
+    {
+        USISR = usi_lsb ? (((uint16_t)second << 8) | first) : (((uint16_t)first << 8) | second);
+        USICNT = USI16B | 16;
+    }
+    else
+    {
+        USISRL = first;
+        USICNT = 8;  /* clears USI16B */
+    }
+}
+
+static void spi_slave_load(uint8_t first)
+{
+    if (rxcount > 1)
+    {
+        spi_slave_shift(first, spi_slave_next_tx(), 16);
+    }
+    else
+    {
+        spi_slave_shift(first, 0, 8);
+    }
+}
+
+/*
+    Restart the bit counter and load the first word. The status hook, if
+    set, supplies the first byte in place of the TX buffer (which then
+    sends count - 1 bytes from its start).
+*/
+static void spi_slave_prime(void)
+{
+    uint8_t first;
+
+    USICTL0 |= USISWRST;
+    USICTL0 &= ~USISWRST;
+    if (status_hook)
+    {
+        first = status_hook();
+        if (txcount)
+        {
+            txcount--;
+        }
+    }
+    else
+    {
+        first = spi_slave_next_tx();
+    }
+    spi_slave_load(first);
+    /* put the first bit on SDO before the first clock edge */
+    USICTL0 |= USIGE;
+    USICTL0 &= ~USIGE;
+    USICTL1 |= USIIE;
+}
+
+#if SPI_SLAVE_HALF_DUPLEX
+/* leave half-duplex; on the single data line SDO stops driving */
+static void spi_slave_half_stop(void)
+{
+    if (wire_mode == 3)
+    {
+        USICTL0 &= ~USIOE;
+    }
+    com_mode &= ~(COM_MODE_HALF | COM_MODE_TURN);
+}
+
+static void spi_slave_half_end(void)
+{
+    spi_slave_half_stop();
+    spi_slave_complete(half_rx);
+}
+
+/*
+    Command received, turn the data line around: the turn hook may fill
+    and shorten the response, the first word is primed and then SDO is
+    enabled. Runs in the counter interrupt of the last command word.
+*/
+static void spi_slave_turn(void)
+{
+    uint16_t count = half_tx;
+    uint16_t size;
+
+    com_mode = (com_mode & ~COM_MODE_HALF) | COM_MODE_TURN;
+    if (turn_hook)
+    {
+        size = turn_hook(rxstart);
+        if (size < count)
+        {
+            count = size;
+        }
+    }
+    if (count == 0)
+    {
+        spi_slave_half_end();
+        return;
+    }
+    rxptr = 0;
+    rxcount = count;
+    txptr = half_txbuf;
+    txcount = count;
+    spi_slave_prime();
+    USICTL0 |= USIOE;
+}
+#else
+#define spi_slave_half_stop()
+#endif
+
+/*
+    Bit order and clock phase/polarity, USI has to be in reset. On the
+    single data line (mode 3) SDO is only enabled after a turnaround.
+*/
+static void spi_slave_format(const uint8_t mode, const uint8_t datamode, const uint8_t order)
+{
+    wire_mode = mode;
+    usi_lsb = (order == 1 /*MSBFIRST*/) ? 0 : 1;
+    USICTL0 = (USICTL0 & ~(USILSB | USIOE)) | (usi_lsb ? USILSB : 0) | (((mode == 3) && SPI_SLAVE_HALF_DUPLEX) ? 0 : USIOE);
+    USICTL1 &= ~USICKPH;
+    USICKCTL &= ~USICKPL;
+    switch (datamode)
+    {
+        case 0: /* SPI_MODE0 */
+            USICTL1 |= SPI_MODE_0_PH;
+            break;
+        case 1: /* SPI_MODE1 */
+            USICTL1 |= SPI_MODE_1_PH;
+            break;
+        case 2: /* SPI_MODE2 */
+            USICTL1 |= SPI_MODE_2_PH;
+            USICKCTL |= USICKPL;
+            break;
+        case 3: /* SPI_MODE3 */
+            USICTL1 |= SPI_MODE_3_PH;
+            USICKCTL |= USICKPL;
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+    spi_slave_initialize() - Configure the USI for SPI slave mode
+
+    P1.7 - SDI aka MOSI
+    P1.6 - SDO aka MISO
+    P1.5 - SCLK
+
+    The USI has no STE input; mode only selects whether the SS pin is
+    configured (see SPISlaveClass::initPins()).
+*/
+
+void spi_slave_initialize(const uint8_t mode, const uint8_t datamode, const uint8_t order)
+{
+    /* Put USI in reset mode, enable the SPI pins, slave (USIMST = 0). */
+    USICTL0 = USISWRST;
+    USICTL0 |= USIPE7 | USIPE6 | USIPE5 | USIOE;
+
+    USICTL1 = 0;
+    USICKCTL = 0;
+    spi_slave_format(mode, datamode, order);
+    com_mode = 0;
+
+    /* Release USI for operation. */
+    USICTL0 &= ~USISWRST;
+}
+
+/**
+    spi_slave_disable() - put USI into reset mode.
+*/
+void spi_slave_disable(void)
+{
+    USICTL1 &= ~USIIE;
+    /* Put USI in reset mode. */
+    USICTL0 |= USISWRST;
+    spi_slave_ready(0);
+    spi_slave_half_stop();
+    com_mode &= ~(COM_MODE_ECHO | COM_MODE_STREAM);
+}
+
+/* stop the transfer in progress, common part of abort and close */
+static void spi_slave_stop(void)
+{
+    USICTL1 &= ~USIIE;
+    USICTL0 |= USISWRST;
+    USICTL0 &= ~USISWRST;
+    spi_slave_half_stop();
+    com_mode &= ~(COM_MODE_ECHO | COM_MODE_HEADER | COM_MODE_STREAM);
+    rxcount = 0;
+    txcount = 0;
+    quiet = 0;
+    frame_begun = 0;
+    spi_slave_ready(0);
+}
+
+/**
+    spi_slave_abort() - drop the transfer in progress.
+
+    Stops the counter interrupt and resets the module, so a frame cut short by the
+    master leaves nothing behind in the shift register. Returns the
+    number of bytes received before the abort.
+*/
+uint16_t spi_slave_abort(void)
+{
+    uint16_t received = spi_bytes_received();
+
+    if (!quiet)
+    {
+        SPI_TRACE_END(received, rxstart, SPI_TRACE_ABORT);
+        SPI_STATS_ABORT();
+    }
+    spi_slave_stop();
+    return (received);
+}
+
+/**
+    spi_slave_close() - end the transfer in progress at the end of its frame.
+
+    As spi_slave_abort(), but traced and counted as a completed frame;
+    one that already completed is not reported twice, one that never
+    started not at all.
+*/
+uint16_t spi_slave_close(void)
+{
+    uint16_t received = spi_bytes_received();
+
+    if (!quiet && (received != 0) && !spi_data_done())
+    {
+        SPI_TRACE_END(received, rxstart, SPI_TRACE_DONE);
+        SPI_STATS_CLOSE(received);
+    }
+    spi_slave_stop();
+    return (received);
+}
+
+/**
+    spi_slave_reconfigure() - change SPI mode and bit order.
+
+    Only the format bits are rewritten, under USISWRST; the interrupt
+    enable and pins are kept. Call it between frames and arm the next
+    transfer afterwards. Returns 1 if the wire mode changed.
+*/
+uint8_t spi_slave_reconfigure(const uint8_t mode, const uint8_t datamode, const uint8_t order)
+{
+    uint8_t changed = (mode != wire_mode);
+
+    USICTL0 |= USISWRST;
+    spi_slave_format(mode, datamode, order);
+    USICTL0 &= ~USISWRST;
+    return (changed);
+}
+
+/**
+    spi_slave_transfer() - send a bytes and recv response.
+
+    rxbuf may be 0, the received bytes are then dropped.
+*/
+
+void spi_slave_transfer(uint8_t *rxbuf, uint8_t *txbuf, uint16_t count)
+{
+#if SPI_SLAVE_DIRECTION == SPI_SLAVE_RX_ONLY
+    (void)txbuf;
+    spi_slave_receive(rxbuf, count);
+    return;
+#endif
+    USICTL1 &= ~USIIE;
+    spi_slave_half_stop();
+    com_mode &= ~(COM_MODE_ECHO | COM_MODE_HEADER | COM_MODE_STREAM | COM_MODE_RX);
+    spi_slave_ready(0);
+    rxcount = count;
+    txcount = count;
+    rxrecived = 0;
+    quiet = 0;
+    frame_begun = 0;
+    arm_kind = ARM_TRANSFER;
+    arm_rx = rxbuf;
+    arm_tx = txbuf;
+    arm_count = count;
+    SPI_TRACE_START(count, ((header_hook && (header_len < count)) ? SPI_TRACE_HEADER : 0));
+    SPI_STATS_ARM();
+    rxptr = rxbuf;
+    rxstart = rxbuf;
+    txptr = txbuf;
+    if (header_hook && (header_len < count) && (rxbuf != 0))
+    {
+        com_mode |= COM_MODE_HEADER;
+    }
+    if (count)
+    {
+        spi_slave_prime();
+    }
+    spi_slave_ready(1);  /* armed, TX data loaded */
+}
+
+/* arm a receive, the master is answered with dummy bytes */
+static void spi_slave_arm_rx(uint8_t *buf, uint16_t count)
+{
+    USICTL1 &= ~USIIE;
+    spi_slave_half_stop();
+    com_mode &= ~(COM_MODE_ECHO | COM_MODE_HEADER | COM_MODE_STREAM);
+    com_mode |= COM_MODE_RX;
+    spi_slave_ready(0);
+    rxcount = count;
+    txcount = count;
+    rxrecived = 0;
+    frame_begun = 0;
+    arm_rx = buf;
+    arm_count = count;
+    rxptr = buf;
+    rxstart = buf;
+    txptr = (uint8_t *) &dummy;
+    if (header_hook && (header_len < count))
+    {
+        com_mode |= COM_MODE_HEADER;
+    }
+    if (count)
+    {
+        spi_slave_prime();
+    }
+}
+
+/**
+    spi_slave_receive() - recv bytes, send dummy bytes.
+*/
+void spi_slave_receive(uint8_t *buf, uint16_t count)
+{
+    quiet = 0;
+    arm_kind = ARM_RECEIVE;
+    SPI_TRACE_START(count, ((header_hook && (header_len < count)) ? SPI_TRACE_HEADER : 0) | SPI_TRACE_RX_ONLY);
+    SPI_STATS_ARM();
+    spi_slave_arm_rx(buf, count);
+    spi_slave_ready(1);  /* armed, TX data loaded */
+}
+
+/**
+    spi_slave_probe() - receive count bytes outside of any frame.
+
+    As spi_slave_receive(), but not traced, not counted in the statistics
+    and the ready pin stays idle; used to hunt for a resync marker.
+*/
+void spi_slave_probe(uint8_t *buf, uint16_t count)
+{
+    quiet = 1;
+    arm_kind = ARM_PROBE;
+    spi_slave_arm_rx(buf, count);
+}
+
+/**
+    spi_slave_rearm() - arm the last transfer, receive or probe again on its buffers.
+
+    Returns 0 if the slave was last put into echo, stream or half-duplex
+    mode, or was never armed.
+*/
+uint8_t spi_slave_rearm(void)
+{
+    switch (arm_kind)
+    {
+        case ARM_TRANSFER:
+            spi_slave_transfer(arm_rx, arm_tx, arm_count);
+            return (1);
+        case ARM_RECEIVE:
+            spi_slave_receive(arm_rx, arm_count);
+            return (1);
+        case ARM_PROBE:
+            spi_slave_probe(arm_rx, arm_count);
+            return (1);
+        default:
+            return (0);
+    }
+}
+
+/**
+    spi_slave_set_frame_timer() - stamp the first byte of every frame with millis().
+*/
+void spi_slave_set_frame_timer(uint8_t on)
+{
+    frame_timer = on;
+}
+
+/**
+    spi_slave_frame_started() - the armed transfer has begun, *ms is the millis() of its first byte.
+
+    Bytes that came in without a stamp are stamped when first seen here.
+*/
+uint8_t spi_slave_frame_started(uint32_t *ms)
+{
+    uint8_t begun;
+    uint16_t sr;
+
+    sr = __get_SR_register();
+    __disable_interrupt();
+    if (!frame_begun && (spi_bytes_received() != 0) && !(com_mode & (COM_MODE_ECHO | COM_MODE_STREAM)))
+    {
+        frame_ms = millis();
+        frame_begun = 1;
+    }
+    begun = frame_begun;
+    *ms = frame_ms;
+    __bis_SR_register(sr & GIE);
+    return (begun);
+}
+
+/**
+    spi_slave_echo() - loop every received byte back to the master.
+
+    The echo is done word by word in the counter interrupt, so the master
+    sees its own data delayed by two bytes. Runs until the next transfer,
+    receive or disable call.
+*/
+void spi_slave_echo(uint8_t xor_mask, uint8_t increment)
+{
+#if SPI_SLAVE_ECHO
+    USICTL1 &= ~USIIE;
+    spi_slave_half_stop();
+    rxcount = 0;
+    txcount = 0;
+    rxrecived = 0;
+    quiet = 0;
+    arm_kind = ARM_NONE;
+    SPI_TRACE_START(0, SPI_TRACE_ECHO);
+    echo_xor = xor_mask;
+    echo_add = increment;
+    com_mode &= ~COM_MODE_STREAM;
+    com_mode |= COM_MODE_ECHO;
+    USICTL0 |= USISWRST;
+    USICTL0 &= ~USISWRST;
+    spi_slave_shift(dummy, dummy, 16);  /* nothing to echo in the first word */
+    USICTL1 |= USIIE;
+    spi_slave_ready(1);
+#else
+    (void)xor_mask;
+    (void)increment;
+#endif
+}
+
+#if SPI_SLAVE_STREAM
+/**
+    spi_slave_stream() - receive without end into the ring buf of size bytes.
+
+    There is no frame: the ring wraps at its end and the oldest data is
+    overwritten, the master is answered with 0xFF. The counter interrupt
+    stores a word at a time, so the last byte of an odd burst shows up
+    with the next one. Runs until the next transfer, receive, echo, abort
+    or disable call.
+*/
+void spi_slave_stream(uint8_t *buf, uint16_t size)
+{
+    USICTL1 &= ~USIIE;
+    spi_slave_half_stop();
+    com_mode &= ~(COM_MODE_ECHO | COM_MODE_HEADER);
+    spi_slave_ready(0);
+    if ((buf == 0) || (size == 0))
+    {
+        return;
+    }
+    rxcount = size;
+    txcount = 0;
+    rxrecived = 0;
+    rxptr = buf;
+    rxstart = buf;
+    txptr = (uint8_t *) &dummy;
+    stream_end = buf + size;
+    stream_size = size;
+    stream_laps = 0;
+    quiet = 0;
+    arm_kind = ARM_NONE;
+    SPI_TRACE_START(size, SPI_TRACE_RX_ONLY | SPI_TRACE_STREAM);
+    com_mode |= COM_MODE_STREAM;
+    USICTL0 |= USISWRST;
+    USICTL0 &= ~USISWRST;
+    spi_slave_shift(dummy, dummy, 16);
+    USICTL1 |= USIIE;
+    spi_slave_ready(1);
+}
+
+/**
+    spi_slave_stream_count() - bytes received since spi_slave_stream(), modulo 2^32.
+*/
+uint32_t spi_slave_stream_count(void)
+{
+    uint32_t laps;
+    uint16_t pos;
+    uint16_t sr;
+
+    sr = __get_SR_register();
+    __disable_interrupt();
+    laps = stream_laps;
+    pos = rxptr - rxstart;
+    __bis_SR_register(sr & GIE);
+    return (laps * stream_size + pos);
+}
+
+/* stream mode: one byte into the ring */
+static void spi_slave_stream_store(uint8_t data)
+{
+    *rxptr++ = data;
+    if (rxptr == stream_end)
+    {
+        rxptr = rxstart;
+        stream_laps++;
+    }
+}
+#endif
+
+#if SPI_SLAVE_HALF_DUPLEX
+/**
+    spi_slave_half_duplex() - receive rx command bytes, then send tx response bytes on the same line.
+
+    One frame in two phases on a single data line (MODE_3WIRE_HALF, SDI
+    and SDO both wired to it). SDO stays disabled while the command comes
+    in; the counter interrupt of its last word arms the response and
+    enables SDO. The master pauses SCK at the turnaround, as between all
+    words. The done hook is called with rx at the end of the response.
+*/
+void spi_slave_half_duplex(uint8_t *rxbuf, uint16_t rx, uint8_t *txbuf, uint16_t tx)
+{
+    USICTL1 &= ~USIIE;
+    spi_slave_half_stop();
+    com_mode &= ~(COM_MODE_ECHO | COM_MODE_HEADER | COM_MODE_STREAM | COM_MODE_RX);
+    spi_slave_ready(0);
+    if (rx == 0)
+    {
+        return;
+    }
+    rxcount = rx;
+    txcount = 0;
+    rxrecived = 0;
+    rxptr = rxbuf;
+    rxstart = rxbuf;
+    txptr = (uint8_t *) &dummy;
+    half_txbuf = txbuf;
+    half_tx = (txbuf != 0) ? tx : 0;
+    half_rx = rx;
+    quiet = 0;
+    frame_begun = 0;
+    arm_kind = ARM_NONE;
+    SPI_TRACE_START(rx + half_tx, 0);
+    SPI_STATS_ARM();
+    com_mode |= COM_MODE_HALF;
+    USICTL0 |= USISWRST;
+    USICTL0 &= ~USISWRST;
+    spi_slave_load(dummy);
+    USICTL1 |= USIIE;
+    spi_slave_ready(1);
+}
+
+/* SDO is enabled and disabled by USIOE, no pin to switch */
+void spi_slave_set_data_pin(uint8_t pin, uint16_t pin_mode)
+{
+    (void)pin;
+    (void)pin_mode;
+}
+
+/**
+    spi_slave_set_turn_hook() - callback at the turnaround of spi_slave_half_duplex().
+
+    Called in interrupt context with the command; it may fill the response
+    buffer and returns the number of response bytes to send, at most tx.
+*/
+void spi_slave_set_turn_hook(uint16_t (*hook)(uint8_t *command))
+{
+#if SPI_SLAVE_HOOKS
+    turn_hook = hook;
+#else
+    (void)hook;
+#endif
+}
+#endif
+
+/**
+    spi_slave_set_header_hook() - size each frame from its first bytes.
+
+    After header bytes of a transfer are received the hook is called (in
+    interrupt context) with a pointer to them and returns the number of
+    bytes still to receive; the transfer is cut down to that length. The
+    USI receives two bytes per interrupt, so an odd header is seen one
+    byte late.
+*/
+void spi_slave_set_header_hook(uint16_t header, uint16_t (*hook)(uint8_t *header))
+{
+#if SPI_SLAVE_HOOKS
+    header_hook = 0;
+    header_len = header;
+    header_hook = hook;
+#else
+    (void)header;
+    (void)hook;
+#endif
+}
+
+/**
+    spi_slave_set_done_hook() - callback at the end of every transfer.
+
+    Called in interrupt context with the number of bytes received; the hook
+    may arm the next transfer right away.
+*/
+void spi_slave_set_done_hook(void (*hook)(uint16_t received))
+{
+#if SPI_SLAVE_HOOKS
+    done_hook = hook;
+#else
+    (void)hook;
+#endif
+}
+
+/**
+    spi_slave_set_status_hook() - supply the first response byte of every frame.
+*/
+void spi_slave_set_status_hook(uint8_t (*hook)(void))
+{
+#if SPI_SLAVE_HOOKS
+    status_hook = hook;
+#else
+    (void)hook;
+#endif
+}
+
+/**
+    spi_slave_set_ready_pin() - data-ready output for master flow control.
+*/
+void spi_slave_set_ready_pin(uint8_t pin, uint8_t active_level)
+{
+    ready_out = 0;
+    if (pin == 0)
+    {
+        return;
+    }
+    ready_mask = digitalPinToBitMask(pin);
+    ready_level = active_level;
+    pinMode(pin, OUTPUT);
+    digitalWrite(pin, (active_level == HIGH) ? LOW : HIGH);
+    ready_out = portOutputRegister(digitalPinToPort(pin));
+}
+
+int spi_bytes_to_transmit(void)
+{
+#if SPI_SLAVE_HALF_DUPLEX
+    if (com_mode & COM_MODE_HALF)
+    {
+        return (half_tx);  /* response not armed yet */
+    }
+#endif
+    return (txcount);
+}
+
+int spi_bytes_received(void)
+{
+#if SPI_SLAVE_HALF_DUPLEX
+    if (com_mode & COM_MODE_TURN)
+    {
+        return (half_rx);
+    }
+#endif
+    return (rxrecived);
+}
+
+#if SPI_SLAVE_ERRORS
+/* the USI has no overrun flag */
+uint16_t spi_slave_errors(void)
+{
+    return (0);
+}
+#endif
+
+/* the USI has no DMA trigger */
+int spi_slave_uses_dma(void)
+{
+    return (0);
+}
+
+int spi_data_done(void)
+{
+    if (com_mode & (COM_MODE_ECHO | COM_MODE_STREAM))
+    {
+        return (0);
+    }
+    return (rxcount == 0);
+}
+
+static void spi_slave_store(uint8_t data)
+{
+    uint16_t rest;
+    uint16_t passed;
+
+    if (rxcount == 0)
+    {
+        return;
+    }
+#if SPI_SLAVE_DIRECTION != SPI_SLAVE_TX_ONLY
+    if (rxptr != 0)
+    {
+        *rxptr++ = data;
+    }
+#endif
+    rxcount--;
+    rxrecived++;
+    if (rxrecived == 1)
+    {
+        if (frame_timer)
+        {
+            frame_ms = millis();
+            frame_begun = 1;
+        }
+        SPI_STATS_FIRST();
+    }
+    if ((com_mode & COM_MODE_HEADER) && (rxrecived >= header_len))
+    {
+        com_mode &= ~COM_MODE_HEADER;
+        rest = header_hook(rxstart);
+        passed = rxrecived - header_len;  /* odd header: one byte already in */
+        rest = (rest > passed) ? (rest - passed) : 0;
+        if (rest < rxcount)
+        {
+            txcount = (txcount > (rxcount - rest)) ? (txcount - (rxcount - rest)) : 0;
+            rxcount = rest;
+        }
+    }
+}
+
+/**
+    spi_slave_usi_isr() - USI counter interrupt, one word has been shifted.
+*/
+__attribute__((interrupt(USI_VECTOR)))
+void spi_slave_usi_isr(void)
+{
+    uint16_t word = USISR;
+    uint8_t wide = USICNT & USI16B;
+    uint8_t first;
+    uint8_t second;
+
+    if (wide)
+    {
+        first = usi_lsb ? (word & 0xFF) : (word >> 8);
+        second = usi_lsb ? (word >> 8) : (word & 0xFF);
+    }
+    else
+    {
+        first = word & 0xFF;
+        second = 0;
+    }
+
+    if (com_mode & COM_MODE_ECHO)
+    {
+        spi_slave_shift((first ^ echo_xor) + echo_add, (second ^ echo_xor) + echo_add, 16);
+        rxrecived += 2;
+        return;
+    }
+#if SPI_SLAVE_STREAM
+    if (com_mode & COM_MODE_STREAM)
+    {
+        spi_slave_stream_store(first);
+        if (wide)
+        {
+            spi_slave_stream_store(second);
+        }
+        spi_slave_shift(dummy, dummy, 16);
+        return;
+    }
+#endif
+
+    spi_slave_store(first);
+    if (wide)
+    {
+        spi_slave_store(second);
+    }
+    if (rxcount)
+    {
+        spi_slave_load(spi_slave_next_tx());
+    }
+    else
+    {
+        USICTL1 &= ~USIIE;  /* the done hook may re-arm */
+#if SPI_SLAVE_HALF_DUPLEX
+        if (com_mode & COM_MODE_HALF)
+        {
+            spi_slave_turn();
+            return;
+        }
+        if (com_mode & COM_MODE_TURN)
+        {
+            spi_slave_half_end();
+            return;
+        }
+#endif
+        spi_slave_complete(rxrecived);
+    }
+}
+
+/* no DMA, SPIMasterBlock runs on byte transfers */
+uint8_t spi_master_block_begin(uint8_t module)
+{
+    (void)module;
+    return (0);
+}
+
+void spi_master_block_start(uint8_t *rxbuf, const uint8_t *txbuf, uint16_t count)
+{
+    (void)rxbuf;
+    (void)txbuf;
+    (void)count;
+}
+
+int spi_master_block_busy(void)
+{
+    return (0);
+}
+
+#endif